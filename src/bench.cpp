@@ -0,0 +1,229 @@
+// bench.cpp - قياسات أداء تُستدعى عبر /bench
+#include "bench.hpp"
+#include "filters.hpp"
+#include "json_writer.hpp"
+#include "sampler.hpp"
+#include "trace_codec.hpp"
+
+namespace {
+  const size_t FRAMES = 256;
+  const int ROUNDS = 8;
+  float input[3 * FRAMES];
+  float output[3 * FRAMES];
+  volatile float sink;
+
+  // إشارة تركيبية: جاذبية + تذبذب + ضجيج (LCG ثابت البذرة لتكرار النتائج)
+  void fillInput() {
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < 3 * FRAMES; i++) {
+      seed = seed * 1664525u + 1013904223u;
+      float noise = ((seed >> 8) & 0xFFFF) / 65535.0f - 0.5f;
+      input[i] = ((i % 3) == 2 ? 1.0f : 0.0f) + 0.3f * sinf(i * 0.01f) + 0.05f * noise;
+    }
+  }
+
+  float perSample(uint32_t cycles) { return (float)cycles / (FRAMES * ROUNDS); }
+
+  float benchKalmanScalar() {
+    KalmanFilter fx, fy, fz;
+    uint32_t start = ESP.getCycleCount();
+    for (int r = 0; r < ROUNDS; r++) {
+      for (size_t i = 0; i < FRAMES; i++) {
+        output[3*i]     = fx.update(input[3*i]);
+        output[3*i + 1] = fy.update(input[3*i + 1]);
+        output[3*i + 2] = fz.update(input[3*i + 2]);
+      }
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+    sink = output[0];
+    return perSample(cycles);
+  }
+
+  float benchKalman3(bool steadyState) {
+    KalmanFilter3 f(0.01f, 0.1f, steadyState);
+    // نحمّي الفلتر حتى يتقارب P فنقيس المسار الساخن المستقر فقط
+    f.update(input, output, FRAMES);
+    uint32_t start = ESP.getCycleCount();
+    for (int r = 0; r < ROUNDS; r++) f.update(input, output, FRAMES);
+    uint32_t cycles = ESP.getCycleCount() - start;
+    sink = output[0];
+    return perSample(cycles);
+  }
+
+  // المسار الساخن لخدمة الاتجاه: نستعمل الإشارة نفسها كجيروسكوب (rad/s) وتسارع (g)
+  float benchMahony() {
+    MahonyFilter f;
+    f.align(input[0], input[1], input[2]);
+    float q[4];
+    uint32_t start = ESP.getCycleCount();
+    for (int r = 0; r < ROUNDS; r++) {
+      for (size_t i = 0; i < FRAMES; i++) {
+        const float* m = input + 3 * i;
+        f.update(m[1], m[0], m[2] - 1.0f, m[0], m[1], m[2], 0.002f);
+      }
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+    f.quaternion(q);
+    sink = q[0];
+    return perSample(cycles);
+  }
+
+  // بيانات رد نموذجي: خمس قيم ثم إحصاءات أربع منها
+  const char* const KEYS[] = {"v0", "angle", "max_height", "range", "time"};
+  const size_t JSON_ROUNDS = 16;
+  char jsonBuf[1024];
+
+  float bytesPerSec(uint32_t bytes, uint32_t cycles) {
+    return cycles ? (float)bytes * ESP.getCpuFreqMHz() * 1e6f / cycles : 0.0f;
+  }
+
+  size_t buildWriter(JsonWriter& w) {
+    w.reset();
+    w.beginObject().field("type", "projectile").field("status", "done");
+    for (size_t i = 0; i < 5; i++) w.field(KEYS[i], input[i] * 10.0f, 2);
+    w.field("trial", 7).field("trials", 10);
+    w.key("stats").beginObject();
+    for (size_t i = 0; i < 4; i++) {
+      w.key(KEYS[i]).beginObject();
+      w.field("n", 7).field("mean", input[i], 3).field("sd", input[i + 3], 3).field("ci95", input[i + 6], 3);
+      w.endObject();
+    }
+    w.endObject().endObject();
+    return w.length();
+  }
+
+  // نفس الرد بأسلوب String السابق (كل + قد يعيد الحجز)
+  String buildString() {
+    String json = "{\"type\":\"projectile\",\"status\":\"done\"";
+    for (size_t i = 0; i < 5; i++) json += ",\"" + String(KEYS[i]) + "\":" + String(input[i] * 10.0f, 2);
+    json += ",\"trial\":" + String(7) + ",\"trials\":" + String(10);
+    json += ",\"stats\":{";
+    for (size_t i = 0; i < 4; i++) {
+      if (i) json += ",";
+      json += "\"" + String(KEYS[i]) + "\":{\"n\":" + String(7);
+      json += ",\"mean\":" + String(input[i], 3);
+      json += ",\"sd\":" + String(input[i + 3], 3);
+      json += ",\"ci95\":" + String(input[i + 6], 3) + "}";
+    }
+    json += "}}";
+    return json;
+  }
+
+  Bench::Serialization benchJsonWriter() {
+    JsonWriter w(jsonBuf, sizeof(jsonBuf));
+    uint32_t freeBefore = ESP.getFreeHeap();
+    size_t bytes = buildWriter(w);
+    int32_t held = (int32_t)(freeBefore - ESP.getFreeHeap());
+    uint32_t start = ESP.getCycleCount();
+    for (size_t r = 0; r < JSON_ROUNDS; r++) buildWriter(w);
+    uint32_t cycles = ESP.getCycleCount() - start;
+    sink = jsonBuf[bytes / 2];
+    return {"writer", (uint32_t)bytes, bytesPerSec(bytes * JSON_ROUNDS, cycles), held};
+  }
+
+  Bench::Serialization benchJsonString() {
+    uint32_t freeBefore = ESP.getFreeHeap();
+    int32_t held;
+    size_t bytes;
+    {
+      String json = buildString();
+      held = (int32_t)(freeBefore - ESP.getFreeHeap());
+      bytes = json.length();
+    }
+    uint32_t start = ESP.getCycleCount();
+    for (size_t r = 0; r < JSON_ROUNDS; r++) sink = buildString().length();
+    uint32_t cycles = ESP.getCycleCount() - start;
+    return {"string", (uint32_t)bytes, bytesPerSec(bytes * JSON_ROUNDS, cycles), held};
+  }
+
+  // مسار تركيبي بصيغة Tap: الإشارة نفسها تسارعاً وجيروسكوباً مع ارتعاش في الأختام الزمنية
+  TraceCodec::Frame frames[FRAMES];
+  TraceCodec::Frame decoded[FRAMES];
+  uint8_t packed[(FRAMES / TraceCodec::BLOCK_FRAMES) * TraceCodec::MAX_BLOCK_BYTES];
+  size_t packedBytes = 0;
+
+  void fillFrames() {
+    uint32_t t = 0;
+    for (size_t i = 0; i < FRAMES; i++) {
+      t += 2000 + (i * 7) % 5;
+      frames[i].t_us = t;
+      for (size_t c = 0; c < 3; c++) {
+        frames[i].a[c] = (int16_t)lrintf(input[3*i + c] * 4096.0f);
+        frames[i].g[c] = (int16_t)lrintf(input[3*i + (c + 1) % 3] * 16.0f * 100.0f);
+      }
+    }
+    // حالات حدية لفحص التطابق: قفزة من أقصى int16 إلى أدناه وفجوة زمنية طويلة
+    frames[FRAMES / 2].a[0] = 32767;
+    frames[FRAMES / 2 + 1].a[0] = -32768;
+    frames[FRAMES - 1].t_us += 1000000;
+  }
+
+  size_t encodeAll() {
+    size_t bytes = 0;
+    for (size_t i = 0; i < FRAMES; i += TraceCodec::BLOCK_FRAMES) {
+      bytes += TraceCodec::encodeBlock(frames + i, FRAMES - i, packed + bytes);
+    }
+    return bytes;
+  }
+
+  size_t decodeAll() {
+    size_t pos = 0, n = 0, used = 0;
+    while (pos < packedBytes) {
+      size_t k = TraceCodec::decodeBlock(packed + pos, packedBytes - pos, decoded + n, &used);
+      if (!k) break;
+      pos += used;
+      n += k;
+    }
+    return n;
+  }
+
+  float benchTraceEncode() {
+    fillFrames();
+    uint32_t start = ESP.getCycleCount();
+    for (int r = 0; r < ROUNDS; r++) packedBytes = encodeAll();
+    uint32_t cycles = ESP.getCycleCount() - start;
+    return perSample(cycles);
+  }
+
+  float benchTraceDecode() {
+    uint32_t start = ESP.getCycleCount();
+    for (int r = 0; r < ROUNDS; r++) sink = decodeAll();
+    uint32_t cycles = ESP.getCycleCount() - start;
+    return perSample(cycles);
+  }
+}
+
+namespace Bench {
+  Codec checkCodec() {
+    fillInput();
+    fillFrames();
+    packedBytes = encodeAll();
+    memset(decoded, 0, sizeof(decoded));
+    bool ok = decodeAll() == FRAMES && memcmp(frames, decoded, sizeof(frames)) == 0;
+    Codec c;
+    c.roundTrip = ok;
+    c.bytesPerFrame = (float)packedBytes / FRAMES;
+    c.ratioVsSample = packedBytes ? (float)(FRAMES * sizeof(Sample)) / packedBytes : 0.0f;
+    return c;
+  }
+
+  size_t runSerialization(Serialization* out, size_t max) {
+    fillInput();
+    size_t n = 0;
+    if (n < max) out[n++] = benchJsonWriter();
+    if (n < max) out[n++] = benchJsonString();
+    return n;
+  }
+
+  size_t run(Result* out, size_t max) {
+    fillInput();
+    size_t n = 0;
+    if (n < max) out[n++] = {"kalman_scalar_x3", benchKalmanScalar()};
+    if (n < max) out[n++] = {"kalman3_adaptive", benchKalman3(false)};
+    if (n < max) out[n++] = {"kalman3_steady", benchKalman3(true)};
+    if (n < max) out[n++] = {"mahony", benchMahony()};
+    if (n < max) out[n++] = {"trace_encode", benchTraceEncode()};
+    if (n < max) out[n++] = {"trace_decode", benchTraceDecode()};
+    return n;
+  }
+}
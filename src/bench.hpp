@@ -0,0 +1,33 @@
+// bench.hpp - قياس كلفة المسارات الساخنة على الجهاز (دورات المعالج لكل عينة)
+#pragma once
+
+#include <Arduino.h>
+
+namespace Bench {
+  struct Result {
+    const char* name;
+    float cyclesPerSample;
+  };
+
+  // يشغّل كل القياسات ويرجع عدد النتائج المكتوبة في out
+  size_t run(Result* out, size_t max);
+
+  // كلفة بناء رد JSON بحجم /results في وضع المحاولات المتعددة
+  struct Serialization {
+    const char* name;
+    uint32_t bytes;     // طول الرد
+    float bytesPerSec;
+    // ما يحتجزه الرد من الكومة وهو قائم، لا عدد عمليات الحجز ولا مجموعها
+    // (لا يوفر القلب عداداً لها؛ انظر program json في بيئة native)
+    int32_t heldBytes;
+  };
+  size_t runSerialization(Serialization* out, size_t max);
+
+  // ترميز مسار تركيبي بـ TraceCodec ثم فكه: التطابق التام ونسبة الضغط مقارنة بـ Sample (float)
+  struct Codec {
+    bool roundTrip;
+    float bytesPerFrame;
+    float ratioVsSample;
+  };
+  Codec checkCodec();
+}
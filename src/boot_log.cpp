@@ -0,0 +1,26 @@
+// boot_log.cpp - سجل مراحل الإقلاع
+#include "boot_log.hpp"
+
+namespace {
+  const char* names[BootLog::MAX_PHASES];
+  uint32_t times[BootLog::MAX_PHASES];
+  size_t n = 0;
+  uint32_t ready = 0;
+}
+
+namespace BootLog {
+  void mark(const char* phase) {
+    uint32_t t = micros();
+    if (ready == 0 && strcmp(phase, "ready") == 0) ready = t;
+    if (n >= MAX_PHASES) return;
+    names[n] = phase;
+    times[n] = t;
+    n++;
+    Serial.printf("[boot] %-16s %8lu us\n", phase, (unsigned long)t);
+  }
+
+  size_t count() { return n; }
+  const char* phase(size_t i) { return i < n ? names[i] : ""; }
+  uint32_t atUs(size_t i) { return i < n ? times[i] : 0; }
+  uint32_t readyUs() { return ready; }
+}
@@ -0,0 +1,16 @@
+// boot_log.hpp - أختام زمنية لمراحل الإقلاع (تُعرض عبر /boot)
+#pragma once
+
+#include <Arduino.h>
+
+namespace BootLog {
+  constexpr size_t MAX_PHASES = 12;
+
+  // يسجل نهاية مرحلة باسم ثابت (سلسلة حرفية) وزمنها منذ الإقلاع بالميكروثانية
+  void mark(const char* phase);
+  size_t count();
+  const char* phase(size_t i);
+  uint32_t atUs(size_t i);
+  // زمن أول مرحلة "ready" أو 0 إن لم يصل الجهاز إليها بعد
+  uint32_t readyUs();
+}
@@ -0,0 +1,213 @@
+// calibration.cpp - آلة حالات المعايرة (تتغذى من Engine::run بلا أي delay)
+#include <M5Unified.h>
+#include <Preferences.h>
+#include "calibration.hpp"
+#include "experiments.hpp"
+#include "sound.hpp"
+
+namespace {
+  const uint16_t PROFILE_VERSION = 2;    // 2: إضافة إزاحة الجيروسكوب
+  const float TEMP_TOLERANCE_C = 10.0f;   // فرق حرارة يستلزم إعادة معايرة السكون
+  const int REST_SAMPLES = 200;
+  const int STILL_WINDOW = 250;           // ~0.5s عند 500Hz
+  const float STILL_MAX_VAR = 0.0004f;    // انحراف معياري < 0.02g على كل محور
+  const float FACE_MIN_G = 0.8f;          // المحور المتجه للأسفل يقرأ قرابة ±1g
+  const uint8_t ALL_FACES = 0x3F;
+
+  struct Profile {
+    uint16_t version;
+    uint16_t hasScale;
+    float bias[3];
+    float scale[3];
+    float rest[3];   // متوسط السكون بعد التصحيح: x, y, z
+    float tempC;
+    float gyroBias[3]; // متوسط الجيروسكوب أثناء السكون (درجة/ث)
+  };
+
+  Profile profile = {PROFILE_VERSION, 0, {0, 0, 0}, {1, 1, 1}, {0, 0, 0}, NAN, {0, 0, 0}};
+  bool profileLoaded = false;
+  Calibration::State current = Calibration::State::Idle;
+  bool finished = false;
+
+  // تراكم Rest
+  int restCount = 0;
+  float restSum[3];
+  float gyroSum[3];
+
+  // تراكم SixPosition
+  int winCount = 0;
+  float winSum[3], winSq[3];
+  uint8_t facesDone = 0;
+  float faceMean[6];
+
+  Preferences prefs;
+
+  void applyRestOffsets() {
+    fric_g0_x = profile.rest[0];
+    pend_g0_y = profile.rest[1];
+    proj_g0 = profile.rest[2];
+  }
+
+  void save() {
+    prefs.begin("imu_cal", false);
+    prefs.putBytes("profile", &profile, sizeof(profile));
+    prefs.end();
+  }
+
+  void resetWindow() {
+    winCount = 0;
+    for (int k = 0; k < 3; k++) { winSum[k] = 0; winSq[k] = 0; }
+  }
+
+  void showFaces() {
+    int n = 0;
+    for (int f = 0; f < 6; f++) if (facesDone & (1 << f)) n++;
+    M5.Display.fillScreen(BLUE); M5.Display.setCursor(0, 60);
+    M5.Display.printf("6-Pos Calibration\nFaces: %d/6\nHold each face still", n);
+  }
+
+  void finishSixPosition() {
+    for (int k = 0; k < 3; k++) {
+      float pos = faceMean[2 * k], neg = faceMean[2 * k + 1];
+      float span = pos - neg;
+      if (span < 1.6f || span > 2.4f) {
+        // قراءة غير منطقية (وجه لم يكن مستوياً): نعيد جمع الأوجه
+        Serial.printf("6-pos calibration rejected on axis %d (span %.3f)\n", k, span);
+        facesDone = 0;
+        showFaces();
+        return;
+      }
+      profile.bias[k] = 0.5f * (pos + neg);
+      profile.scale[k] = 2.0f / span;
+    }
+    profile.hasScale = 1;
+    Serial.printf("Accel bias: %.4f %.4f %.4f scale: %.4f %.4f %.4f\n",
+      profile.bias[0], profile.bias[1], profile.bias[2], profile.scale[0], profile.scale[1], profile.scale[2]);
+    // الإزاحات السابقة حُسبت بتصحيح قديم: نتبعها مباشرة بمعايرة سكون
+    Hal::showStatus(Hal::Color::Blue, "Lay flat & still...");
+    Calibration::startRest();
+  }
+
+  void feedSixPosition(const Sample& s) {
+    const float a[3] = {s.ax, s.ay, s.az};
+    for (int k = 0; k < 3; k++) { winSum[k] += a[k]; winSq[k] += a[k] * a[k]; }
+    if (++winCount < STILL_WINDOW) return;
+
+    float mean[3];
+    bool still = true;
+    for (int k = 0; k < 3; k++) {
+      mean[k] = winSum[k] / winCount;
+      if (winSq[k] / winCount - mean[k] * mean[k] > STILL_MAX_VAR) still = false;
+    }
+    resetWindow();
+    if (!still) return;
+
+    int axis = 0;
+    for (int k = 1; k < 3; k++) if (fabsf(mean[k]) > fabsf(mean[axis])) axis = k;
+    if (fabsf(mean[axis]) < FACE_MIN_G) return;
+    int face = 2 * axis + (mean[axis] < 0 ? 1 : 0);
+    if (facesDone & (1 << face)) return;
+
+    faceMean[face] = mean[axis];
+    facesDone |= (1 << face);
+    Sound::trigger(Sound::Event::CalibratePosition);
+    showFaces();
+    if (facesDone == ALL_FACES) finishSixPosition();
+  }
+
+  void feedRest(Sample s) {
+    gyroSum[0] += s.gx; gyroSum[1] += s.gy; gyroSum[2] += s.gz; // قبل طرح الإزاحة القديمة
+    Calibration::apply(&s, 1);
+    restSum[0] += s.ax; restSum[1] += s.ay; restSum[2] += s.az;
+    if (++restCount < REST_SAMPLES) return;
+
+    for (int k = 0; k < 3; k++) {
+      profile.rest[k] = restSum[k] / REST_SAMPLES;
+      profile.gyroBias[k] = gyroSum[k] / REST_SAMPLES;
+    }
+    profile.version = PROFILE_VERSION;
+    profile.tempC = Sampler::temperature();
+    applyRestOffsets();
+    save();
+    profileLoaded = true;
+    current = Calibration::State::Idle;
+    finished = true;
+    Sound::trigger(Sound::Event::CalibrateDone);
+    Serial.printf("Accel offsets: Z=%.4f, Y=%.4f, X=%.4f (T=%.1fC)\n", proj_g0, pend_g0_y, fric_g0_x, profile.tempC);
+    Serial.printf("Gyro bias: %.3f %.3f %.3f dps\n", profile.gyroBias[0], profile.gyroBias[1], profile.gyroBias[2]);
+  }
+}
+
+namespace Calibration {
+  bool load() {
+    Profile p;
+    prefs.begin("imu_cal", true);
+    size_t len = prefs.getBytesLength("profile") == sizeof(p) ? prefs.getBytes("profile", &p, sizeof(p)) : 0;
+    prefs.end();
+    if (len != sizeof(p) || p.version != PROFILE_VERSION) return false;
+
+    profile = p;
+    profileLoaded = true;
+    applyRestOffsets();
+
+    // أول دفعة من Sampler تحمل الحرارة خلال ~10ms
+    for (int i = 0; i < 10 && isnan(Sampler::temperature()); i++) delay(5);
+    float t = Sampler::temperature();
+    if (!isnan(t) && !isnan(p.tempC) && fabsf(t - p.tempC) > TEMP_TOLERANCE_C) {
+      Serial.printf("Calibration profile from %.1fC, now %.1fC: rest offsets stale\n", p.tempC, t);
+      return false;
+    }
+    Serial.printf("Calibration profile loaded (T=%.1fC, scale=%d)\n", p.tempC, p.hasScale);
+    return true;
+  }
+
+  void startRest() {
+    restCount = 0;
+    restSum[0] = restSum[1] = restSum[2] = 0;
+    gyroSum[0] = gyroSum[1] = gyroSum[2] = 0;
+    current = State::Rest;
+    Sound::trigger(Sound::Event::CalibrateStart);
+  }
+
+  void startSixPosition() {
+    facesDone = 0;
+    resetWindow();
+    current = State::SixPosition;
+    Sound::trigger(Sound::Event::CalibrateStart);
+    showFaces();
+  }
+
+  State state() { return current; }
+  uint8_t positionsDone() { return facesDone; }
+  bool hasProfile() { return profileLoaded; }
+  float profileTemperature() { return profile.tempC; }
+
+  bool takeFinished() {
+    bool f = finished;
+    finished = false;
+    return f;
+  }
+
+  void feed(const Sample* samples, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      if (current == State::Rest) feedRest(samples[i]);
+      else if (current == State::SixPosition) feedSixPosition(samples[i]);
+      else return;
+    }
+  }
+
+  void apply(Sample* samples, size_t n) {
+    const float gbx = profile.gyroBias[0], gby = profile.gyroBias[1], gbz = profile.gyroBias[2];
+    for (size_t i = 0; i < n; i++) {
+      samples[i].gx -= gbx; samples[i].gy -= gby; samples[i].gz -= gbz;
+    }
+    if (!profile.hasScale) return;
+    const float bx = profile.bias[0], by = profile.bias[1], bz = profile.bias[2];
+    const float sx = profile.scale[0], sy = profile.scale[1], sz = profile.scale[2];
+    for (size_t i = 0; i < n; i++) {
+      samples[i].ax = (samples[i].ax - bx) * sx;
+      samples[i].ay = (samples[i].ay - by) * sy;
+      samples[i].az = (samples[i].az - bz) * sz;
+    }
+  }
+}
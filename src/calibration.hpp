@@ -0,0 +1,33 @@
+// calibration.hpp - معايرة IMU غير حاجزة (إزاحات السكون + معايرة 6 أوضاع) مع حفظ في NVS
+#pragma once
+
+#include "hal.hpp"
+#include "sampler.hpp"
+
+namespace Calibration {
+  // Rest: متوسط 200 عينة في وضع السكون (proj_g0, pend_g0_y, fric_g0_x) وإزاحة الجيروسكوب
+  // SixPosition: يضع المستخدم الجهاز على أوجهه الستة بأي ترتيب؛ كل وجه ثابت يُلتقط
+  //              تلقائياً، ثم تُحسب الإزاحة والمقياس لكل محور وتتبعها معايرة Rest
+  enum class State { Idle, Rest, SixPosition };
+
+  // يحمّل الملف المحفوظ ويطبقه. يرجع false إن لم يوجد ملف صالح
+  // (إصدار مختلف أو فرق حرارة كبير عن وقت المعايرة) وعندها تلزم معايرة جديدة.
+  bool load();
+
+  void startRest();
+  void startSixPosition();
+  State state();
+  inline bool busy() { return state() != State::Idle; }
+  // بت لكل وجه ملتقط: 0:+X 1:-X 2:+Y 3:-Y 4:+Z 5:-Z
+  uint8_t positionsDone();
+  bool hasProfile();
+  float profileTemperature();
+
+  // true مرة واحدة بعد انتهاء آخر معايرة
+  bool takeFinished();
+
+  // يستهلك العينات الخام أثناء المعايرة (يُستدعى من Engine::run)
+  void feed(const Sample* samples, size_t n);
+  // يطبق الإزاحة والمقياس على دفعة خام: a = (raw - bias) * scale و g = raw - gyroBias
+  void apply(Sample* samples, size_t n);
+}
@@ -0,0 +1,126 @@
+// capture.cpp - تنفيذ حلقة الالتقاط
+#include "capture.hpp"
+#include "filters.hpp"
+#include <atomic>
+
+namespace {
+  Capture::Record* ring = nullptr;
+  size_t cap = 0;
+  bool psram = false;
+  size_t head = 0;    // موضع الكتابة التالي
+  size_t filled = 0;  // عدد السجلات الصالحة (≤ cap)
+  size_t pre = Capture::DEFAULT_PRE, post = Capture::DEFAULT_POST;
+  Capture::State st = Capture::State::Off;
+  const char* trigEvent = "";
+  size_t trigPos = 0, afterTrig = 0;
+  size_t winStart = 0, winLen = 0, winTrig = 0;
+  // يُسلَّح على loop() ويُقرأ من مهمة HTTP أثناء التنزيل
+  std::atomic<uint32_t> armCount(0);
+  std::atomic<uint32_t> exporters(0);
+  // فلتر مستقل عن accelFilter حتى يبقى التسجيل متصلاً بين التجارب
+  KalmanFilter3 filter;
+  bool filterPrimed = false;
+
+  void freeze() {
+    size_t oldest = filled < cap ? 0 : head;
+    size_t before = (trigPos + cap - oldest) % cap;
+    size_t p = before < pre ? before : pre;
+    winStart = (trigPos + cap - p) % cap;
+    winTrig = p;
+    winLen = p + 1 + afterTrig;
+    st = Capture::State::Frozen;
+  }
+}
+
+namespace Capture {
+  bool begin() {
+    if (ring) return true;
+    ring = (Record*)Hal::psramAlloc(PSRAM_CAPACITY * sizeof(Record));
+    if (ring) { cap = PSRAM_CAPACITY; psram = true; }
+    else {
+      ring = (Record*)malloc(HEAP_CAPACITY * sizeof(Record));
+      if (!ring) return false;
+      cap = HEAP_CAPACITY;
+    }
+    setWindow(pre, post);
+    arm();
+    return true;
+  }
+
+  bool inPsram() { return psram; }
+  size_t capacity() { return cap; }
+
+  void setWindow(size_t p, size_t q) {
+    if (cap > 0) {
+      // النافذة = pre + عينة الحدث + post
+      if (q > cap - 1) q = cap - 1;
+      if (p > cap - 1 - q) p = cap - 1 - q;
+    }
+    pre = p; post = q;
+  }
+  size_t preSamples() { return pre; }
+  size_t postSamples() { return post; }
+
+  void arm() {
+    if (!ring) return;
+    // الزيادة تسبق أي كتابة في الحلقة (acq_rel: لا يتقدم عليها ما بعدها)، فالقارئ
+    // الذي يجد العدد نفسه بعد النسخ نسخ نافذة لم تُمس
+    armCount.fetch_add(1, std::memory_order_acq_rel);
+    head = 0; filled = 0; afterTrig = 0; winLen = 0;
+    trigEvent = "";
+    st = State::Recording;
+  }
+
+  void feed(const Sample* s, size_t n) {
+    if (st != State::Recording && st != State::Triggered) return;
+    const size_t CHUNK = 64;
+    float f[3 * CHUNK];
+    for (size_t base = 0; base < n; base += CHUNK) {
+      size_t m = n - base < CHUNK ? n - base : CHUNK;
+      if (!filterPrimed) { filter.reset(s[base].ax, s[base].ay, s[base].az); filterPrimed = true; }
+      for (size_t i = 0; i < m; i++) {
+        const Sample& x = s[base + i];
+        f[3*i] = x.ax; f[3*i + 1] = x.ay; f[3*i + 2] = x.az;
+      }
+      filter.update(f, f, m);
+      for (size_t i = 0; i < m; i++) {
+        const Sample& x = s[base + i];
+        Record& r = ring[head];
+        r.t_us = x.t_us; r.ax = x.ax; r.ay = x.ay; r.az = x.az;
+        r.fx = f[3*i]; r.fy = f[3*i + 1]; r.fz = f[3*i + 2];
+        head = (head + 1) % cap;
+        if (filled < cap) filled++;
+        if (st == State::Triggered && ++afterTrig >= post) { freeze(); return; }
+      }
+    }
+  }
+
+  void trigger(uint32_t t_us, const char* ev) {
+    if (st != State::Recording || filled == 0) return;
+    // الحدث يُكشف داخل الدفعة التي سُجلت للتو، فنبحث عن عينته من الأحدث للأقدم
+    size_t back = 0;
+    size_t pos = (head + cap - 1) % cap;
+    while (back + 1 < filled && (int32_t)(ring[pos].t_us - t_us) > 0) {
+      pos = (pos + cap - 1) % cap; back++;
+    }
+    trigPos = pos; afterTrig = back;
+    trigEvent = ev;
+    st = State::Triggered;
+    if (afterTrig >= post) { afterTrig = post; freeze(); }
+  }
+
+  State state() { return st; }
+  const char* event() { return trigEvent; }
+  size_t length() { return st == State::Frozen ? winLen : 0; }
+  size_t triggerIndex() { return winTrig; }
+  uint32_t generation() {
+    // ما نُسخ قبل الاستدعاء يُقرأ قبل العدد
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return armCount.load(std::memory_order_acquire);
+  }
+
+  void beginExport() { exporters.fetch_add(1, std::memory_order_relaxed); }
+  void endExport() { exporters.fetch_sub(1, std::memory_order_relaxed); }
+  bool exporting() { return exporters.load(std::memory_order_relaxed) > 0; }
+  const Record& at(size_t i) { return ring[(winStart + i) % cap]; }
+}
@@ -0,0 +1,59 @@
+// capture.hpp - تسجيل مستمر للعينات في PSRAM وتجميد نافذة قبل/بعد حدث الكشف
+#pragma once
+
+#include "hal.hpp"
+#include "sampler.hpp"
+
+namespace Capture {
+  // عينة خام (بعد المعايرة) + القيمة المنعّمة بفلتر Kalman خاص بالالتقاط
+  struct Record {
+    uint32_t t_us;
+    float ax, ay, az;
+    float fx, fy, fz;
+  };
+
+  // Recording: الحلقة تُكتب باستمرار وتنتظر حدثاً
+  // Triggered: وقع الحدث؛ نكمل حتى تمتلئ نافذة ما بعد الحدث
+  // Frozen:    النافذة مجمدة ولا تُكتب حتى التسليح التالي (Engine::start)
+  enum class State { Off, Recording, Triggered, Frozen };
+
+  // 16384 سجل × 28 بايت ≈ 460 KB في PSRAM (≈ 33 ث عند 500 Hz).
+  // بدون PSRAM نكتفي بحلقة صغيرة في الذاكرة العادية.
+  constexpr size_t PSRAM_CAPACITY = 16384;
+  constexpr size_t HEAP_CAPACITY = 1024;
+  constexpr size_t DEFAULT_PRE = 500;
+  constexpr size_t DEFAULT_POST = 1500;
+
+  // يحجز الحلقة ويبدأ التسجيل. يرجع false إن فشل الحجز (يبقى Off)
+  bool begin();
+  bool inPsram();
+  size_t capacity();
+
+  // عدد العينات قبل الحدث وبعده؛ يُقص المجموع ليتسع في الحلقة
+  void setWindow(size_t pre, size_t post);
+  size_t preSamples();
+  size_t postSamples();
+
+  // يمسح الحلقة ويعود للتسجيل بانتظار حدث جديد
+  void arm();
+  // يُستدعى من Engine::run بكل دفعة بعد تطبيق المعايرة
+  void feed(const Sample* samples, size_t n);
+  // حدث كشف (رمية، بدء تأرجح، إفلات، انزلاق) عند العينة ذات الختم t_us.
+  // أول حدث بعد التسليح فقط هو الذي يُعتمد
+  void trigger(uint32_t t_us, const char* event);
+
+  State state();
+  const char* event();
+  // النافذة المجمدة مرتبة زمنياً؛ طولها 0 قبل التجميد
+  size_t length();
+  size_t triggerIndex();
+  const Record& at(size_t i);
+  // يزيد مع كل تسليح: قارئ من مهمة أخرى يقرأه قبل النسخ وبعده ليتحقق أن النافذة
+  // لم تتغير أثناء قراءتها
+  uint32_t generation();
+  // تنزيل جارٍ للنافذة (CaptureExport): إعادة التسليح التلقائية بين المحاولات تنتظره
+  // (انظر Engine::REARM_MAX_HOLD_MS)، أما /start و /reset فتقطعانه
+  void beginExport();
+  void endExport();
+  bool exporting();
+}
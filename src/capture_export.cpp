@@ -0,0 +1,103 @@
+// capture_export.cpp - بث النافذة المجمدة بصيغتي CSV والثنائية
+#include "capture_export.hpp"
+#include "json_writer.hpp"
+
+namespace {
+  alignas(4) char chunk[CaptureExport::CHUNK]; // يُستعمل أيضاً كمصفوفة Record في الصيغة الثنائية
+
+  // الزمن بالمللي ثانية بثلاث منازل من فرق صحيح بالميكروثانية (بلا خطأ float)
+  size_t formatMs(char* out, int32_t dtUs) {
+    size_t n = 0;
+    uint32_t a = dtUs < 0 ? (uint32_t)(-(int64_t)dtUs) : (uint32_t)dtUs;
+    if (dtUs < 0) out[n++] = '-';
+    char tmp[10];
+    size_t k = 0;
+    uint32_t ms = a / 1000;
+    do { tmp[k++] = (char)('0' + ms % 10); ms /= 10; } while (ms);
+    while (k) out[n++] = tmp[--k];
+    uint32_t frac = a % 1000;
+    out[n++] = '.';
+    out[n++] = (char)('0' + frac / 100);
+    out[n++] = (char)('0' + frac / 10 % 10);
+    out[n++] = (char)('0' + frac % 10);
+    return n;
+  }
+
+  // سطر CSV واحد؛ أطول سطر ممكن = 7 حقول × FLOAT_CHARS + الفواصل
+  const size_t MAX_ROW = 7 * (JsonWriter::FLOAT_CHARS + 1);
+
+  size_t formatRow(char* out, const Capture::Record& r, uint32_t t0) {
+    size_t n = formatMs(out, (int32_t)(r.t_us - t0));
+    const float v[6] = {r.ax, r.ay, r.az, r.fx, r.fy, r.fz};
+    for (size_t i = 0; i < 6; i++) {
+      out[n++] = ',';
+      n += JsonWriter::formatFloat(out + n, v[i], 4);
+    }
+    out[n++] = '\n';
+    return n;
+  }
+
+  void sendCsv(WebServer& server, size_t count, uint32_t generation) {
+    static const char HEAD[] = "t_ms,ax,ay,az,fx,fy,fz\n";
+    server.sendHeader("Content-Disposition", "attachment; filename=\"capture.csv\"");
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN); // HTTP/1.1: Transfer-Encoding: chunked
+    server.send(200, "text/csv", "");
+    uint32_t t0 = Capture::at(Capture::triggerIndex()).t_us;
+    size_t len = sizeof(HEAD) - 1;
+    memcpy(chunk, HEAD, len);
+    for (size_t i = 0; i < count; i++) {
+      if (len + MAX_ROW > sizeof(chunk)) {
+        // أعيد التسليح أثناء الإرسال: نقطع الاتصال بدل إرسال بيانات من تسجيل آخر
+        if (Capture::generation() != generation) { server.client().stop(); return; }
+        server.sendContent(chunk, len);
+        len = 0;
+      }
+      len += formatRow(chunk + len, Capture::at(i), t0);
+    }
+    if (Capture::generation() != generation) { server.client().stop(); return; }
+    server.sendContent(chunk, len);
+    server.sendContent(""); // الجزء الأخير الفارغ ينهي الرد
+  }
+
+  void sendBinary(WebServer& server, size_t count, uint32_t generation) {
+    CaptureExport::Header h;
+    memcpy(h.magic, "CAP1", 4);
+    h.recordSize = sizeof(Capture::Record);
+    h.rateHz = Sampler::rate();
+    h.count = count;
+    h.triggerIndex = Capture::triggerIndex();
+    memset(h.event, 0, sizeof(h.event));
+    strncpy(h.event, Capture::event(), sizeof(h.event) - 1);
+
+    server.sendHeader("Content-Disposition", "attachment; filename=\"capture.bin\"");
+    server.setContentLength(sizeof(h) + count * sizeof(Capture::Record));
+    server.send(200, "application/octet-stream", "");
+    server.sendContent((const char*)&h, sizeof(h));
+
+    // النافذة متصلة منطقياً لكنها قد تلتف في الحلقة، فننسخ سجلاً سجلاً إلى الجزء
+    const size_t perChunk = sizeof(chunk) / sizeof(Capture::Record);
+    Capture::Record* out = (Capture::Record*)chunk;
+    for (size_t i = 0; i < count; ) {
+      size_t n = count - i < perChunk ? count - i : perChunk;
+      for (size_t k = 0; k < n; k++) out[k] = Capture::at(i + k);
+      if (Capture::generation() != generation) { server.client().stop(); return; }
+      server.sendContent(chunk, n * sizeof(Capture::Record));
+      i += n;
+    }
+  }
+}
+
+namespace CaptureExport {
+  void send(WebServer& server) {
+    uint32_t generation = Capture::generation();
+    size_t count = Capture::length();
+    if (Capture::state() != Capture::State::Frozen || count == 0) {
+      server.send(404, "text/plain", "No frozen capture");
+      return;
+    }
+    Capture::beginExport();
+    if (server.arg("format") == "bin") sendBinary(server, count, generation);
+    else sendCsv(server, count, generation);
+    Capture::endExport();
+  }
+}
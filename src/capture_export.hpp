@@ -0,0 +1,32 @@
+// capture_export.hpp - تنزيل النافذة المجمدة من حلقة الالتقاط (GET /export) بثاً على أجزاء
+#pragma once
+
+#include <Arduino.h>
+#include <WebServer.h>
+#include "capture.hpp"
+
+namespace CaptureExport {
+  // الصيغة الثنائية: هذه الترويسة ثم count سجلاً من Capture::Record كما هي في الذاكرة
+  // (little-endian: uint32 t_us ثم ست قيم float: ax, ay, az, fx, fy, fz)
+  struct __attribute__((packed)) Header {
+    char magic[4];          // "CAP1"
+    uint16_t recordSize;    // sizeof(Capture::Record)
+    uint16_t rateHz;        // معدل أخذ العينات
+    uint32_t count;
+    uint32_t triggerIndex;
+    char event[16];         // اسم حدث الكشف (منتهٍ بصفر)
+  };
+  static_assert(sizeof(Header) == 32, "CaptureExport::Header must stay 32 bytes on the wire");
+  static_assert(sizeof(Capture::Record) == 28, "Capture::Record layout is part of the export format");
+
+  // حجم الجزء المرسل في كل كتابة (≈ مقطع TCP واحد)
+  constexpr size_t CHUNK = 1460;
+
+  // GET /export?format=csv (افتراضياً) أو format=bin.
+  // CSV بترميز chunked: t_ms (نسبةً للحدث), ax, ay, az, fx, fy, fz بوحدة g.
+  // الثنائي بطول معلوم. لا يُبنى الرد كاملاً في الذاكرة: يُنسخ من الحلقة جزءاً جزءاً،
+  // ويتوقف إن أعيد تسليح الالتقاط أثناء الإرسال. في وضع المحاولات المتعددة تنتظر
+  // إعادة التسليح التلقائية (بعد REARM_DELAY_MS) انتهاء التنزيل حتى REARM_MAX_HOLD_MS،
+  // فلا يُقطع إلا تنزيل أبطأ من ذلك أو بدء تجربة يدوياً. 404 إن لم تكن هناك نافذة مجمدة
+  void send(WebServer& server);
+}
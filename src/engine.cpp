@@ -0,0 +1,155 @@
+// engine.cpp - تنفيذ محرك التجارب
+#include "engine.hpp"
+#include "calibration.hpp"
+#include "capture.hpp"
+#include "orientation.hpp"
+#include "recorder.hpp"
+#include "run_log.hpp"
+#include "tap.hpp"
+
+namespace {
+  // مصفوفة عادية (تهيئة ساكنة) حتى يكون التسجيل آمناً من ترتيب التهيئة بين الملفات
+  Experiment* table[Engine::MAX_EXPERIMENTS];
+  size_t tableCount = 0;
+  Experiment* current = nullptr;
+  Sample batch[Engine::BATCH_SIZE];
+
+  // وضع المحاولات المتعددة
+  size_t trialsTarget = 1, trialsCompleted = 0;
+  bool trialRecorded = false;
+  bool rearmed = false;
+  bool recording = false; // /start?...&record=1: كل محاولة تُسجل جلسةً في Recorder
+  uint32_t doneAtMs = 0;
+  Engine::TrialStat trialStats[Engine::MAX_METRICS];
+  size_t trialStatCount = 0;
+  uint32_t stateVersion = 0;
+
+  void arm(Experiment* e) {
+    stateVersion++;
+    experimentState = e->initialState();
+    trialRecorded = false;
+    Sampler::discard(); // نبدأ من عينات جديدة فقط
+    Capture::arm();
+    Recorder::finish(nullptr); // محاولة سابقة لم تكتمل (بدء جديد دون إيقاف)
+    if (recording) Recorder::start(e);
+    Sound::trigger(e->startEvent());
+  }
+
+  // نتائج المحاولة المنتهية تُضاف للإحصاءات بالمفتاح (ترتيب المقاييس ثابت لكل تجربة)
+  void recordTrial() {
+    trialRecorded = true;
+    doneAtMs = Hal::millis();
+    Metric m[Engine::MAX_METRICS];
+    size_t n = current->failed() ? 0 : current->metrics(m, Engine::MAX_METRICS);
+    size_t results = 0;
+    for (size_t i = 0; i < n; i++) if (!m[i].aux) results++;
+    // محاولة فاشلة أو دون نتيجة: تُعاد بعد المهلة نفسها، وتبقى جلستها المسجلة دون نتائج
+    if (!results) {
+      Recorder::finish(nullptr);
+      return;
+    }
+    trialsCompleted++;
+    for (size_t i = 0; i < n; i++) {
+      if (m[i].aux) continue;
+      size_t k = 0;
+      while (k < trialStatCount && strcmp(trialStats[k].key, m[i].key) != 0) k++;
+      if (k == trialStatCount) {
+        if (trialStatCount >= Engine::MAX_METRICS) continue;
+        trialStats[k].key = m[i].key;
+        trialStats[k].decimals = m[i].decimals;
+        trialStats[k].stats.reset();
+        trialStatCount++;
+      }
+      trialStats[k].stats.push(m[i].value);
+    }
+    RunLog::append(current, trialsCompleted);
+    Recorder::finish(current);
+  }
+}
+
+namespace Engine {
+  void registerExperiment(Experiment* e) {
+    if (!e || tableCount >= MAX_EXPERIMENTS) return;
+    table[tableCount++] = e;
+  }
+
+  size_t count() { return tableCount; }
+  Experiment* at(size_t i) { return i < tableCount ? table[i] : nullptr; }
+  Experiment* active() { return current; }
+
+  Experiment* find(const char* name) {
+    for (size_t i = 0; i < tableCount; i++) {
+      if (strcmp(table[i]->name(), name) == 0) return table[i];
+    }
+    return nullptr;
+  }
+
+  Experiment* start(const char* name, Experiment::ParamFn param) {
+    Experiment* e = find(name);
+    if (!e) return nullptr;
+    e->reset();
+    e->configure(param);
+    current = e;
+    activeExperiment = e->type();
+    float t = param("trials");
+    trialsTarget = t >= 1 ? (t > MAX_TRIALS ? MAX_TRIALS : (size_t)t) : 1;
+    trialsCompleted = 0;
+    trialStatCount = 0;
+    rearmed = false;
+    recording = param("record") > 0;
+    arm(e);
+    return e;
+  }
+
+  void stop() {
+    stateVersion++;
+    Recorder::finish(nullptr); // جلسة دون نتيجة (مفيدة لحالات عدم الكشف)
+    current = nullptr;
+    trialsTarget = 1; trialsCompleted = 0; trialStatCount = 0;
+    activeExperiment = NONE;
+    experimentState = IDLE;
+  }
+
+  void resetAll() {
+    for (size_t i = 0; i < tableCount; i++) table[i]->reset();
+  }
+
+  void run() {
+    size_t n;
+    while ((n = Sampler::popBatch(batch, BATCH_SIZE)) > 0) {
+      // المعايرة الجارية تستهلك العينات الخام، والتجارب تنتظر حتى تنتهي
+      if (Calibration::busy()) { Calibration::feed(batch, n); continue; }
+      Calibration::apply(batch, n);
+      Orientation::update(batch, n); // التجارب تقرأ نواتجها عبر Orientation::batch()
+      Tap::write(batch, n);          // للبث الحي (GET :81/stream)
+      // الالتقاط يسجل دائماً حتى تكتمل نافذة ما بعد الحدث ولو انتهت التجربة
+      Capture::feed(batch, n);
+      Recorder::feed(batch, n);
+      if (!current || experimentState == IDLE || experimentState == DONE) continue;
+      current->process(batch, n);
+      stateVersion++;
+      if (experimentState == DONE && !trialRecorded) recordTrial();
+    }
+    // المحاولة التالية بعد مهلة، بنفس معاملات الإعداد، دون قطع تنزيل نافذة الالتقاط
+    uint32_t sinceDone = Hal::millis() - doneAtMs;
+    if (current && experimentState == DONE && trialsCompleted < trialsTarget && sinceDone >= REARM_DELAY_MS &&
+        (!Capture::exporting() || sinceDone >= REARM_MAX_HOLD_MS)) {
+      current->reset();
+      arm(current);
+      rearmed = true;
+    }
+  }
+
+  size_t trials() { return trialsTarget; }
+  size_t trialsDone() { return trialsCompleted; }
+  size_t statCount() { return trialStatCount; }
+  const TrialStat& stat(size_t i) { return trialStats[i]; }
+
+  uint32_t version() { return stateVersion; }
+
+  bool takeRearmed() {
+    bool r = rearmed;
+    rearmed = false;
+    return r;
+  }
+}
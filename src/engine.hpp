@@ -0,0 +1,95 @@
+// engine.hpp - محرك التجارب: جدول تسجيل + معالجة العينات على دفعات
+#pragma once
+
+#include "hal.hpp"
+#include "experiments.hpp"
+#include "sampler.hpp"
+#include "sound.hpp"
+#include "stats.hpp"
+
+// قيمة رقمية واحدة تعرضها التجربة في /results
+struct Metric {
+    const char* key;
+    float value;
+    uint8_t decimals;
+    // مدخل مكرر (الزاوية، الطول) أو مؤشر جودة (الثقة، الخطأ): يُعرض ويُحفظ
+    // لكنه لا يدخل في إحصاءات المحاولات. يُترك في التهيئة فيكون false (نتيجة)
+    bool aux;
+};
+
+// كل تجربة تطبق هذه الواجهة وتسجل نفسها في الجدول (انظر Engine::Registrar)
+class Experiment {
+public:
+    // يقرأ معامل الطلب بالاسم (مثل "mass" أو "length")
+    typedef float (*ParamFn)(const char* key);
+
+    virtual ~Experiment() {}
+    virtual ExperimentType type() const = 0;
+    virtual const char* name() const = 0;            // القيمة المقابلة في /start?type=
+    virtual const char* startText() const = 0;       // ما يظهر على الشاشة بعد البدء
+    virtual Sound::Event startEvent() const = 0;
+    virtual ExperimentState initialState() const { return WAITING; }
+
+    virtual void configure(ParamFn param) = 0;
+    virtual void reset() = 0;
+    // تُستدعى بدفعة كاملة من العينات المتتالية (بالترتيب الزمني)
+    virtual void process(const Sample* samples, size_t n) = 0;
+    // القيم الحالية: التقدم أثناء RUNNING أو النتائج عند DONE
+    virtual size_t metrics(Metric* out, size_t max) const = 0;
+    // DONE دون نتيجة صالحة (مثل رمية تعذر إعادة بناء مسارها): لا تُحتسب المحاولة
+    // ولا تُحفظ، وتظهر في /results بالحالة "failed"
+    virtual bool failed() const { return false; }
+    // معاملات الإعداد كما قرأتها configure() (تُحفظ مع النتائج في سجل التشغيلات)
+    virtual size_t params(Metric* out, size_t max) const { (void)out; (void)max; return 0; }
+};
+
+namespace Engine {
+  constexpr size_t MAX_EXPERIMENTS = 8;
+  constexpr size_t BATCH_SIZE = 64;
+  constexpr size_t MAX_METRICS = 8;
+  constexpr size_t MAX_TRIALS = 100;
+  // مهلة بين DONE وإعادة التسليح في وضع المحاولات المتعددة (لإعادة الجهاز لمكانه)
+  constexpr uint32_t REARM_DELAY_MS = 3000;
+  // وتتأخر ما دام /export ينزّل نافذة المحاولة المنتهية، حتى هذا الحد
+  constexpr uint32_t REARM_MAX_HOLD_MS = 30000;
+
+  // إحصاءات قيمة نتيجة واحدة (بنفس مفتاح Metric، دون aux) عبر المحاولات المكتملة
+  struct TrialStat {
+    const char* key;
+    uint8_t decimals;
+    RunningStats stats;
+  };
+
+  void registerExperiment(Experiment* e);
+  size_t count();
+  Experiment* at(size_t i);
+  Experiment* find(const char* name);
+  Experiment* active();
+
+  // يفعّل التجربة بالاسم ويرجع nullptr إن لم تكن مسجلة.
+  // المعامل "trials" (افتراضياً 1) يعيد تسليح التجربة نفسها تلقائياً بعد كل DONE
+  // حتى يكتمل العدد، وتتراكم نتائج كل محاولة في TrialStat
+  Experiment* start(const char* name, Experiment::ParamFn param);
+  void stop();
+  void resetAll();
+
+  size_t trials();        // العدد المطلوب
+  size_t trialsDone();    // المحاولات المكتملة
+  size_t statCount();
+  const TrialStat& stat(size_t i);
+  // true مرة واحدة بعد كل إعادة تسليح تلقائية (لتحديث الشاشة في loop)
+  bool takeRearmed();
+  // يزيد مع كل ما قد يغير /results (دفعة عينات عولجت، بدء، إيقاف، إعادة تسليح).
+  // ثابت بعد DONE، فلا يُعاد بناء الرد ما دام لم يتغير شيء
+  uint32_t version();
+
+  // يسحب العينات المتراكمة من Sampler ويمررها للمعايرة الجارية أو (بعد تطبيق
+  // تصحيح المعايرة) لخدمة الاتجاه وحلقة الالتقاط ثم للتجربة النشطة دفعةً دفعة.
+  // يُستدعى في كل دورة loop()
+  void run();
+
+  // للتسجيل الساكن: static Engine::Registrar reg(&myExperiment);
+  struct Registrar {
+    explicit Registrar(Experiment* e) { registerExperiment(e); }
+  };
+}
@@ -1,12 +1,14 @@
 // experiments.cpp - تنفيذ منطق التجارب بعد فصلها عن main.cpp
-#include <M5Unified.h>
 #include "filters.hpp"
+#include "pipeline.hpp"
+#include "period_estimator.hpp"
 #include "experiments.hpp"
+#include "engine.hpp"
+#include "capture.hpp"
+#include "orientation.hpp"
 
-// الجاذبية القياسية (معرّفة في main.cpp أيضاً كـ extern)
-extern KalmanFilter axFilter;
-extern KalmanFilter ayFilter;
-extern KalmanFilter azFilter;
+// فلتر كالمان للمحاور الثلاثة معاً (SoA + كسب ثابت بعد التقارب)
+KalmanFilter3 accelFilter;
 // (أزيل playSound القديم بعد اعتماد نظام Sound الحدثي)
 #include "sound.hpp"
 
@@ -20,14 +22,13 @@ ExperimentState experimentState = IDLE;
 // -----------------------------
 // متغيرات المقذوفات
 // -----------------------------
-float proj_g0 = 0.0f, proj_mass = 0.5f, proj_velocity = 0.0f, proj_height = 0.0f;
+float proj_g0 = 0.0f, proj_mass = 0.5f;
 unsigned long proj_time_us = 0;
 float proj_V0 = 0.0f, proj_T = 0.0f, proj_h_max = 0.0f, proj_g_exp = 0.0f, proj_F_max = 0.0f;
 float proj_angle_deg = 45.0f; 
 bool proj_freefall_started = false;
 int  proj_landing_samples_count = 0;
-float proj_g_sum = 0.0f; 
-int  proj_g_samples = 0;
+Trajectory proj_trajectory;
 const float PROJ_THROW_DETECT_THRESHOLD = 2.5f;
 const float PROJ_FREEFALL_DETECT_THRESHOLD = 1.2f;
 const float PROJ_LANDING_DETECT_THRESHOLD = 0.2f;
@@ -39,15 +40,17 @@ const int   PROJ_LANDING_SAMPLES_REQUIRED = 20;
 float pend_period = 0.0f, pend_frequency = 0.0f, pend_string_length = 0.5f, pend_g_exp = 0.0f;
 int   pend_oscillations_to_measure = 10;
 int   pend_oscillation_count = 0;
-unsigned long pend_startTime = 0;
-bool  pend_isSwinging = false;
+float pend_period_err = 0.0f, pend_confidence = 0.0f;
 float pend_g0_y = 0.0f;
 const float PEND_SWING_THRESHOLD = 0.2f;
+const float PEND_CROSSING_HYSTERESIS = 0.03f;
+const float PEND_EARLY_STOP_REL_ERR = 0.002f;
 
 // -----------------------------
 // متغيرات السقوط الحر
 // -----------------------------
 float freefall_distance = 1.0f, freefall_time = 0.0f, freefall_g_exp = 0.0f;
+float freefall_time_err = 0.0f, freefall_g_err = 0.0f;
 unsigned long freefall_start_time = 0;
 const float FREEFALL_DETECT_THRESHOLD = 0.3f; 
 const float FREEFALL_IMPACT_THRESHOLD = 3.5f; 
@@ -58,69 +61,124 @@ const float FREEFALL_IMPACT_THRESHOLD = 3.5f;
 float fric_g0_x = 0.0f, fric_g0_z = 0.0f;
 float fric_current_angle = 0.0f, fric_critical_angle = 0.0f, fric_mu = 0.0f;
 float fric_zero_angle = 0.0f;
-const float FRIC_SLIP_THRESHOLD = 0.5f;
+float fric_onset_lag_ms = 0.0f;
+const float FRIC_SLIP_THRESHOLD = 0.15f;
+const int   FRIC_SLIP_CONFIRM_SAMPLES = 10;
+const float FRIC_ONSET_SIGMA = 4.0f;
+const int   FRIC_QUIET_SAMPLES = 5;
 
 // ------------------------------------------------------------------
 // إعادة ضبط
 // ------------------------------------------------------------------
 void resetExperimentData() {
-    proj_velocity = 0.0f; proj_height = 0.0f; proj_V0 = 0.0f; proj_T = 0.0f; proj_h_max = 0.0f; proj_g_exp = 0.0f; proj_F_max = 0.0f;
-    proj_freefall_started = false; proj_landing_samples_count = 0; proj_g_sum = 0.0f; proj_g_samples = 0;
-    pend_period = 0.0f; pend_frequency = 0.0f; pend_oscillation_count = 0; pend_isSwinging = false; pend_g_exp = 0.0f;
-    freefall_time = 0.0f; freefall_g_exp = 0.0f;
-    fric_current_angle = 0.0f; fric_critical_angle = 0.0f; fric_mu = 0.0f;
+    Engine::resetAll();
 }
 
+// تنعيم الدفعة كاملة قبل الكشف: f[3*i + 0..2] = x, y, z المنعّمة للعينة i
+static void filterBatch(const Sample* s, size_t n, float* f) {
+    for (size_t i = 0; i < n; i++) { f[3*i] = s[i].ax; f[3*i + 1] = s[i].ay; f[3*i + 2] = s[i].az; }
+    accelFilter.update(f, f, n);
+}
+
+static void showDone() {
+    Hal::showStatus(Hal::Color::DarkGreen, "DONE! \nCheck browser.");
+}
+
+namespace {
+
 // ------------------------------------------------------------------
 // منطق المقذوفات
 // ------------------------------------------------------------------
-void projectileController() {
-    static unsigned long last_update_us = 0;
-    if (experimentState == IDLE || experimentState == DONE) return;
-
-    float ax_raw, ay_raw, az_raw;
-    M5.Imu.getAccelData(&ax_raw, &ay_raw, &az_raw);
-    float ax = axFilter.update(ax_raw);
-    float ay = ayFilter.update(ay_raw);
-    float az = azFilter.update(az_raw);
-
-    float net_accel_g = az - proj_g0;
-    float vertical_accel = net_accel_g * GRAVITY_CONST;
-
-    if (experimentState == WAITING) {
-        if (vertical_accel > PROJ_THROW_DETECT_THRESHOLD * GRAVITY_CONST) {
-            experimentState = RUNNING;
-            last_update_us = micros();
-            Sound::trigger(Sound::Event::ProjectileThrow);
-            M5.Display.fillScreen(ORANGE); M5.Display.setCursor(0, 80); M5.Display.println("THROW DETECTED!");
-        }
-        return;
+class ProjectileExperiment : public Experiment {
+    // إزاحة التسارع الرأسي الخطي أثناء الانتظار (بقايا خطأ المقياس)
+    float linBias = 0.0f;
+    bool reconstructed = false;
+public:
+    ExperimentType type() const override { return PROJECTILE; }
+    const char* name() const override { return "projectile"; }
+    const char* startText() const override { return "Projectile Exp.\nWaiting for throw..."; }
+    Sound::Event startEvent() const override { return Sound::Event::ExperimentStartProjectile; }
+
+    void configure(ParamFn param) override {
+        proj_mass = param("mass");
+        proj_angle_deg = param("angle");
     }
 
-    if (experimentState == RUNNING) {
-        unsigned long current_us = micros();
-        float dt = (current_us - last_update_us) / 1000000.0f;
-        last_update_us = current_us;
+    size_t params(Metric* out, size_t max) const override {
+        if (max < 2) return 0;
+        out[0] = {"mass", proj_mass, 3};
+        out[1] = {"angle", proj_angle_deg, 1};
+        return 2;
+    }
 
-        if (!proj_freefall_started) {
-            proj_velocity += vertical_accel * dt;
-            float current_force = proj_mass * fabs(vertical_accel);
-            if (current_force > proj_F_max) proj_F_max = current_force;
+    void reset() override {
+        proj_V0 = 0.0f; proj_T = 0.0f; proj_h_max = 0.0f; proj_g_exp = 0.0f; proj_F_max = 0.0f;
+        proj_freefall_started = false; proj_landing_samples_count = 0;
+        proj_trajectory.reset();
+        linBias = 0.0f;
+        reconstructed = false;
+    }
+
+    // التسارع الرأسي في الإطار الأرضي من خدمة الاتجاه: لا يفترض بقاء Z الجهاز رأسياً أثناء الرمية
+    void process(const Sample* samples, size_t n) override {
+        const Orientation::Pose* pose = Orientation::batch();
+        for (size_t i = 0; i < n && experimentState != DONE; i++) step(samples[i].t_us, pose[i].lz);
+    }
 
-            if (fabs(net_accel_g) < PROJ_FREEFALL_DETECT_THRESHOLD) {
-                proj_freefall_started = true;
-                proj_V0 = proj_velocity;
+    bool failed() const override { return experimentState == DONE && !reconstructed; }
+
+    size_t metrics(Metric* out, size_t max) const override {
+        if (experimentState != DONE || !reconstructed || max < 8) return 0;
+        // الزمن وأقصى ارتفاع مقاسان من المسار المعاد بناؤه؛ القيم النظرية للمقارنة.
+        // proj_V0 هي المركبة الرأسية (التكامل في الإطار الأرضي)، والأفقية من زاوية الإطلاق.
+        // تحت MIN_ANGLE_DEG لا تكفي المركبة الرأسية لاستنتاج الأفقية فلا يُحسب مدى
+        const float MIN_ANGLE_DEG = 5.0f;
+        float angle_rad = proj_angle_deg * PI / 180.0;
+        float v0y = proj_V0;
+        float v0x = proj_angle_deg >= MIN_ANGLE_DEG ? v0y * cosf(angle_rad) / sinf(angle_rad) : 0.0f;
+        float speed = sqrtf(v0x * v0x + v0y * v0y);
+        float time_theory = (2 * v0y) / GRAVITY_CONST;
+        float max_height_theory = (v0y * v0y) / (2 * GRAVITY_CONST);
+        float range = v0x * proj_T;
+        out[0] = {"v0", speed, 3};
+        out[1] = {"angle", proj_angle_deg, 1, true};
+        out[2] = {"time", proj_T, 3};
+        out[3] = {"max_height", proj_h_max, 3};
+        out[4] = {"range", range, 3};
+        out[5] = {"time_theory", time_theory, 3};
+        out[6] = {"max_height_theory", max_height_theory, 3};
+        out[7] = {"g", proj_g_exp, 2};
+        return 8;
+    }
+
+private:
+    // المسار الساخن: تسجيل + كشف الحالات فقط؛ التكامل كله في finish()
+    void step(uint32_t current_us, float lz) {
+        float net_accel_g = lz - linBias;
+        float vertical_accel = net_accel_g * GRAVITY_CONST;
+
+        if (experimentState == WAITING) {
+            if (fabsf(net_accel_g) < 0.1f) linBias += 0.01f * (lz - linBias);
+            proj_trajectory.pushPre(current_us, vertical_accel);
+            if (vertical_accel > PROJ_THROW_DETECT_THRESHOLD * GRAVITY_CONST) {
+                experimentState = RUNNING;
+                proj_trajectory.beginThrow();
                 proj_time_us = current_us;
-                proj_height = 0.0f; proj_h_max = 0.0f;
-                Sound::trigger(Sound::Event::ProjectileFreefall);
-                M5.Display.fillScreen(BLUE); M5.Display.setCursor(0, 80); M5.Display.println("FREEFALL...");
+                Capture::trigger(current_us, "throw");
+                Sound::trigger(Sound::Event::ProjectileThrow);
+                Hal::showStatus(Hal::Color::Orange, "THROW DETECTED!");
             }
-        } else {
-            proj_velocity += (net_accel_g * GRAVITY_CONST) * dt;
-            proj_height += proj_velocity * dt;
-            if (proj_height > proj_h_max) proj_h_max = proj_height; // الإصلاح
-            proj_g_sum += fabs(net_accel_g);
-            proj_g_samples++;
+            return;
+        }
+
+        bool room = proj_trajectory.push(current_us, vertical_accel);
+
+        if (!proj_freefall_started && fabs(net_accel_g) < PROJ_FREEFALL_DETECT_THRESHOLD) {
+            proj_freefall_started = true;
+            proj_trajectory.markFreefall();
+            proj_time_us = current_us;
+            Sound::trigger(Sound::Event::ProjectileFreefall);
+            Hal::showStatus(Hal::Color::Blue, "FREEFALL...");
         }
 
         if (proj_freefall_started && fabs(net_accel_g) < PROJ_LANDING_DETECT_THRESHOLD) {
@@ -129,105 +187,348 @@ void projectileController() {
             proj_landing_samples_count = 0;
         }
 
-        if (proj_landing_samples_count >= PROJ_LANDING_SAMPLES_REQUIRED) {
-            experimentState = DONE;
-            proj_T = (current_us - proj_time_us) / 1000000.0f;
-            proj_g_exp = (proj_g_samples > 0) ? (proj_g_sum / proj_g_samples) * GRAVITY_CONST : 0;
-            Sound::trigger(Sound::Event::ExperimentDone);
-            M5.Display.fillScreen(DARKGREEN); M5.Display.setCursor(0, 80); M5.Display.println("DONE! \nCheck browser.");
+        if (proj_landing_samples_count >= PROJ_LANDING_SAMPLES_REQUIRED || !room) {
+            proj_trajectory.markRest(proj_landing_samples_count);
+            finish();
         }
     }
-}
+
+    void finish() {
+        Trajectory::Result r = proj_trajectory.reconstruct(GRAVITY_CONST);
+        reconstructed = r.ok;
+        if (r.ok) {
+            proj_V0 = r.v0; proj_T = r.flightTime; proj_h_max = r.apex;
+            proj_g_exp = r.gExp; proj_F_max = proj_mass * r.maxAccel;
+        }
+        experimentState = DONE;
+        if (!r.ok) {
+            // سقوط غير مكتمل أو التقاط قبل السكون: يعيد المحرك التسليح بعد المهلة
+            Hal::showStatus(Hal::Color::Orange, "NO VALID THROW\nRe-arming...");
+            return;
+        }
+        Sound::trigger(Sound::Event::ExperimentDone);
+        showDone();
+    }
+};
 
 // ------------------------------------------------------------------
 // منطق البندول
 // ------------------------------------------------------------------
-void pendulumController() {
-    if (experimentState == IDLE || experimentState == DONE) return;
-    static float last_smoothed_g_y = 0.0f; static bool was_increasing = false; static unsigned long last_peak_time = 0;
-
-    float ax_raw, ay_raw, az_raw; M5.Imu.getAccelData(&ax_raw, &ay_raw, &az_raw);
-    float ax = axFilter.update(ax_raw); (void)ax; // غير مستخدم مباشرة الآن
-    float ay = ayFilter.update(ay_raw); float az = azFilter.update(az_raw); (void)az;
-    float current_g_y = ay - pend_g0_y;
-
-    if (experimentState == WAITING) {
-        if (fabs(current_g_y) > PEND_SWING_THRESHOLD) {
-            experimentState = RUNNING;
-            last_smoothed_g_y = 0; was_increasing = false; last_peak_time = 0;
-            M5.Display.fillScreen(ORANGE); M5.Display.setCursor(0, 80); M5.Display.println("Measuring...");
-            Sound::trigger(Sound::Event::PendulumMeasureStart);
+class PendulumExperiment : public Experiment {
+    // تنعيم إضافي فوق Kalman لكشف القمم (EMA بمعامل 0.4)
+    Pipeline<Ema> peakSmoother;
+    PeriodEstimator estimator{PEND_CROSSING_HYSTERESIS};
+    float last_smoothed_g_y = 0.0f; bool was_increasing = false; unsigned long last_peak_time = 0;
+public:
+    ExperimentType type() const override { return PENDULUM; }
+    const char* name() const override { return "pendulum"; }
+    const char* startText() const override { return "Pendulum Exp.\nWaiting for swing..."; }
+    Sound::Event startEvent() const override { return Sound::Event::ExperimentStartPendulum; }
+
+    void configure(ParamFn param) override {
+        pend_string_length = param("length");
+        pend_oscillations_to_measure = (int)param("oscillations");
+    }
+
+    size_t params(Metric* out, size_t max) const override {
+        if (max < 2) return 0;
+        out[0] = {"length", pend_string_length, 2};
+        out[1] = {"oscillations", (float)pend_oscillations_to_measure, 0};
+        return 2;
+    }
+
+    void reset() override {
+        pend_period = 0.0f; pend_frequency = 0.0f; pend_oscillation_count = 0; pend_g_exp = 0.0f;
+        pend_period_err = 0.0f; pend_confidence = 0.0f;
+        estimator.reset();
+        peakSmoother.reset(); peakSmoother.stage<0>().setAlpha(0.4f);
+        last_smoothed_g_y = 0.0f; was_increasing = false; last_peak_time = 0;
+    }
+
+    void process(const Sample* samples, size_t n) override {
+        float f[3 * Engine::BATCH_SIZE];
+        filterBatch(samples, n, f);
+        for (size_t i = 0; i < n && experimentState != DONE; i++) step(samples[i].t_us, f[3*i + 1]);
+    }
+
+    size_t metrics(Metric* out, size_t max) const override {
+        if (experimentState == RUNNING && max >= 3) {
+            // التقدير الجاري متاح بعد ثلاثة عبورات (اهتزازة ونصف)
+            out[0] = {"count", (float)pend_oscillation_count, 0};
+            out[1] = {"period", pend_period, 4};
+            out[2] = {"confidence", pend_confidence, 2, true};
+            return 3;
         }
-        return;
+        if (experimentState != DONE || max < 6) return 0;
+        out[0] = {"length", pend_string_length, 2, true};
+        out[1] = {"period", pend_period, 4};
+        out[2] = {"freq", pend_frequency, 4};
+        out[3] = {"g", pend_g_exp, 2};
+        out[4] = {"period_err", pend_period_err, 5, true};
+        out[5] = {"confidence", pend_confidence, 2, true};
+        return 6;
     }
 
-    if (experimentState == RUNNING) {
-        float smoothed_g_y = (current_g_y * 0.4f) + (last_smoothed_g_y * 0.6f);
+private:
+    void step(uint32_t t_us, float ay) {
+        unsigned long now_ms = t_us / 1000UL;
+        float current_g_y = ay - pend_g0_y;
+
+        if (experimentState == WAITING) {
+            if (fabs(current_g_y) > PEND_SWING_THRESHOLD) {
+                experimentState = RUNNING;
+                Capture::trigger(t_us, "swing");
+                peakSmoother.reset(); estimator.reset(); last_smoothed_g_y = 0; was_increasing = false; last_peak_time = 0;
+                Hal::showStatus(Hal::Color::Orange, "Measuring...");
+                Sound::trigger(Sound::Event::PendulumMeasureStart);
+            }
+            return;
+        }
+
+        float smoothed_g_y; peakSmoother.push(current_g_y, smoothed_g_y);
         bool is_increasing = smoothed_g_y > last_smoothed_g_y;
-        if (millis() - last_peak_time > 250) {
+        if (now_ms - last_peak_time > 250) {
             if ((was_increasing && !is_increasing && smoothed_g_y > PEND_SWING_THRESHOLD) || (!was_increasing && is_increasing && smoothed_g_y < -PEND_SWING_THRESHOLD)) {
-                Sound::trigger(Sound::Event::PendulumPeak); last_peak_time = millis();
+                Sound::trigger(Sound::Event::PendulumPeak); last_peak_time = now_ms;
             }
         }
         was_increasing = is_increasing; last_smoothed_g_y = smoothed_g_y;
 
-        bool previousState = pend_isSwinging; pend_isSwinging = current_g_y > 0;
-        if (previousState != pend_isSwinging) {
-            if (pend_oscillation_count == 0) pend_startTime = millis();
-            pend_oscillation_count++;
-            if (pend_oscillation_count >= pend_oscillations_to_measure * 2) {
-                unsigned long endTime = millis(); float totalTime = (endTime - pend_startTime) / 1000.0f;
-                pend_period = totalTime / pend_oscillations_to_measure;
-                if (pend_period > 0) { pend_frequency = 1.0f / pend_period; pend_g_exp = (4.0f * PI * PI * pend_string_length) / (pend_period * pend_period); } else { pend_frequency = 0; pend_g_exp = 0; }
-                experimentState = DONE;
-                Sound::trigger(Sound::Event::ExperimentDone);
-                M5.Display.fillScreen(DARKGREEN); M5.Display.setCursor(0, 80); M5.Display.println("DONE! \nCheck browser.");
-            }
+        if (!estimator.push(t_us, current_g_y)) return;
+        pend_oscillation_count = estimator.crossings();
+        if (!estimator.hasEstimate()) return;
+        pend_period = estimator.period();
+        pend_period_err = estimator.uncertainty();
+        pend_confidence = estimator.confidence();
+
+        // نتوقف عند العدد المطلوب، أو مبكراً بعد 3 اهتزازات إن كان التقدير دقيقاً بما يكفي
+        bool enough = pend_oscillation_count >= pend_oscillations_to_measure * 2;
+        bool precise = pend_oscillation_count >= 6 && pend_period > 0 && pend_period_err / pend_period < PEND_EARLY_STOP_REL_ERR;
+        if (enough || precise) {
+            if (pend_period > 0) { pend_frequency = 1.0f / pend_period; pend_g_exp = (4.0f * PI * PI * pend_string_length) / (pend_period * pend_period); } else { pend_frequency = 0; pend_g_exp = 0; }
+            experimentState = DONE;
+            Sound::trigger(Sound::Event::ExperimentDone);
+            showDone();
         }
     }
-}
+};
 
 // ------------------------------------------------------------------
 // منطق السقوط الحر
 // ------------------------------------------------------------------
-void freefallController() {
-    if (experimentState == IDLE || experimentState == DONE) return;
-    float ax_raw, ay_raw, az_raw; M5.Imu.getAccelData(&ax_raw, &ay_raw, &az_raw);
-    float ax = axFilter.update(ax_raw); float ay = ayFilter.update(ay_raw); float az = azFilter.update(az_raw);
-    float total_accel_mag = sqrtf(ax*ax + ay*ay + az*az);
-    if (experimentState == WAITING) {
-        if (total_accel_mag < FREEFALL_DETECT_THRESHOLD) {
-            experimentState = RUNNING; freefall_start_time = millis();
-            M5.Display.fillScreen(ORANGE); M5.Display.setCursor(0, 80); M5.Display.println("FALLING...");
-            Sound::trigger(Sound::Event::FreefallStart);
+class FreefallExperiment : public Experiment {
+    // العينة السابقة: نستوفي لحظة عبور العتبة بينها وبين الحالية
+    bool havePrev = false;
+    uint32_t prevT = 0; float prevMag = 0;
+    // لحظة بدء السقوط = startBase + startOffUs (نفصلهما حتى لا نفقد دقة float)
+    uint32_t startBase = 0; float startOffUs = 0; float startSigmaUs = 0;
+    // تقدير ضجيج المقدار أثناء السكون (متوسط وتباين أسّيان)
+    float restMean = 1.0f, restVar = 0.0f;
+public:
+    ExperimentType type() const override { return FREEFALL; }
+    const char* name() const override { return "freefall"; }
+    const char* startText() const override { return "Free Fall Exp.\nWaiting for drop..."; }
+    Sound::Event startEvent() const override { return Sound::Event::ExperimentStartFreefall; }
+
+    void configure(ParamFn param) override {
+        freefall_distance = param("distance");
+    }
+
+    size_t params(Metric* out, size_t max) const override {
+        if (max < 1) return 0;
+        out[0] = {"distance", freefall_distance, 3};
+        return 1;
+    }
+
+    void reset() override {
+        freefall_time = 0.0f; freefall_g_exp = 0.0f; freefall_time_err = 0.0f; freefall_g_err = 0.0f;
+        havePrev = false; restMean = 1.0f; restVar = 0.0f;
+    }
+
+    // تأخر Kalman يزيح الحافتين بمقدارين مختلفين، لذا نعمل على المقدار الخام (بعد المعايرة)
+    void process(const Sample* samples, size_t n) override {
+        for (size_t i = 0; i < n && experimentState != DONE; i++) {
+            const Sample& s = samples[i];
+            step(s.t_us, sqrtf(s.ax*s.ax + s.ay*s.ay + s.az*s.az));
         }
-        return;
     }
-    if (experimentState == RUNNING) {
-        if (total_accel_mag > FREEFALL_IMPACT_THRESHOLD) {
-            unsigned long endTime = millis(); freefall_time = (endTime - freefall_start_time) / 1000.0f;
-            if (freefall_time > 0.05f) freefall_g_exp = (2.0f * freefall_distance) / (freefall_time * freefall_time); else { freefall_time = 0; freefall_g_exp = 0; }
+
+    size_t metrics(Metric* out, size_t max) const override {
+        if (experimentState != DONE || max < 4) return 0;
+        out[0] = {"time", freefall_time, 4};
+        out[1] = {"g", freefall_g_exp, 3};
+        out[2] = {"time_err", freefall_time_err, 5, true};
+        out[3] = {"g_err", freefall_g_err, 3, true};
+        return 4;
+    }
+
+private:
+    // يستوفي لحظة عبور العتبة بين (prevT, prevMag) و (t, mag) ويقدّر انحرافها المعياري:
+    // ضجيج المقدار مقسوماً على ميل الحافة + حد دقة الاستيفاء بين عينتين (Δt/√12)
+    void crossing(uint32_t t, float mag, float threshold, float& offUs, float& sigmaUs) const {
+        float dtUs = (float)(int32_t)(t - prevT);
+        float dm = mag - prevMag;
+        float frac = fabsf(dm) > 1e-6f ? (threshold - prevMag) / dm : 1.0f;
+        offUs = constrain(frac, 0.0f, 1.0f) * dtUs;
+        float slopePerUs = fabsf(dm) / dtUs;
+        float noiseUs = slopePerUs > 0 ? sqrtf(restVar) / slopePerUs : dtUs;
+        float resUs = dtUs / 3.4641f;
+        sigmaUs = sqrtf(noiseUs * noiseUs + resUs * resUs);
+    }
+
+    void step(uint32_t t, float mag) {
+        if (!havePrev) { havePrev = true; prevT = t; prevMag = mag; return; }
+
+        if (experimentState == WAITING) {
+            if (mag < FREEFALL_DETECT_THRESHOLD && prevMag >= FREEFALL_DETECT_THRESHOLD) {
+                crossing(t, mag, FREEFALL_DETECT_THRESHOLD, startOffUs, startSigmaUs);
+                startBase = prevT;
+                experimentState = RUNNING; freefall_start_time = startBase / 1000UL;
+                Capture::trigger(t, "drop");
+                Hal::showStatus(Hal::Color::Orange, "FALLING...");
+                Sound::trigger(Sound::Event::FreefallStart);
+            } else {
+                restMean += 0.01f * (mag - restMean);
+                restVar += 0.01f * ((mag - restMean) * (mag - restMean) - restVar);
+            }
+        } else if (mag > FREEFALL_IMPACT_THRESHOLD) {
+            float endOffUs, endSigmaUs;
+            crossing(t, mag, FREEFALL_IMPACT_THRESHOLD, endOffUs, endSigmaUs);
+            freefall_time = ((float)(int32_t)(prevT - startBase) + endOffUs - startOffUs) / 1e6f;
+            freefall_time_err = sqrtf(startSigmaUs * startSigmaUs + endSigmaUs * endSigmaUs) / 1e6f;
+            if (freefall_time > 0.05f) {
+                freefall_g_exp = (2.0f * freefall_distance) / (freefall_time * freefall_time);
+                freefall_g_err = freefall_g_exp * 2.0f * freefall_time_err / freefall_time;
+            } else { freefall_time = 0; freefall_g_exp = 0; freefall_time_err = 0; freefall_g_err = 0; }
             experimentState = DONE;
             Sound::trigger(Sound::Event::FreefallImpact);
-            M5.Display.fillScreen(DARKGREEN); M5.Display.setCursor(0, 80); M5.Display.println("DONE! \nCheck browser.");
+            showDone();
         }
+        prevT = t; prevMag = mag;
     }
-}
+};
 
 // ------------------------------------------------------------------
 // منطق الاحتكاك
 // ------------------------------------------------------------------
-void frictionController() {
-    if (experimentState == IDLE || experimentState == DONE) return;
-    float ax_raw, ay_raw, az_raw; M5.Imu.getAccelData(&ax_raw, &ay_raw, &az_raw);
-    float ax = axFilter.update(ax_raw); float az = azFilter.update(az_raw); (void)ay_raw; (void)ayFilter; // المحور Y غير مستخدم هنا
-    float pitch = atan2f(-ax, az) * 180.0f / PI; fric_current_angle = pitch;
-    if (fabs(ax - fric_g0_x) > FRIC_SLIP_THRESHOLD) {
-        if (experimentState == RUNNING) {
-            fric_critical_angle = fric_current_angle; fric_mu = tanf(fric_critical_angle * PI / 180.0f); experimentState = DONE;
-            Sound::trigger(Sound::Event::FrictionSlip);
-            Sound::trigger(Sound::Event::ExperimentDone);
-            M5.Display.fillScreen(DARKGREEN); M5.Display.setCursor(0, 80); M5.Display.println("DONE! \nCheck browser.");
+class FrictionExperiment : public Experiment {
+    // تاريخ آخر ~0.5 ث (عند 500Hz) للبحث عن بداية الانزلاق بعد تأكيده
+    static const size_t HISTORY = 256;
+    struct Point { uint32_t t_us; float angle, jerk, gyroDev; };
+    Point history[HISTORY];
+    size_t histHead = 0, histCount = 0;
+
+    bool havePrev = false;
+    uint32_t prevT = 0; float prevA[3] = {0, 0, 0};
+    float gyroEma[3] = {0, 0, 0};   // خط أساس بطيء لدوران الإمالة اليدوية
+    // متوسط وتباين أسّيان للهزة وانحراف الجيروسكوب أثناء الإمالة الهادئة
+    float jerkMean = 0, jerkVar = 0, gyroMean = 0, gyroVar = 0;
+    int slipCount = 0;
+public:
+    ExperimentType type() const override { return FRICTION; }
+    const char* name() const override { return "friction"; }
+    const char* startText() const override { return "Friction Exp.\nTilting..."; }
+    Sound::Event startEvent() const override { return Sound::Event::ExperimentStartFriction; }
+    ExperimentState initialState() const override { return RUNNING; } // يبدأ القياس فوراً
+
+    void configure(ParamFn) override {}
+
+    void reset() override {
+        fric_current_angle = 0.0f; fric_critical_angle = 0.0f; fric_mu = 0.0f; fric_onset_lag_ms = 0.0f;
+        histHead = 0; histCount = 0; havePrev = false; slipCount = 0;
+        jerkMean = jerkVar = gyroMean = gyroVar = 0;
+    }
+
+    // بلا Kalman: تأخره يجعل الزاوية المسجلة بعد نقطة الانزلاق الفعلية
+    void process(const Sample* samples, size_t n) override {
+        const Orientation::Pose* pose = Orientation::batch();
+        for (size_t i = 0; i < n && experimentState != DONE; i++) step(samples[i], pose[i].pitch);
+    }
+
+    size_t metrics(Metric* out, size_t max) const override {
+        if (experimentState == RUNNING && max >= 1) {
+            out[0] = {"angle", fric_current_angle, 2};
+            return 1;
         }
+        if (experimentState != DONE || max < 3) return 0;
+        out[0] = {"angle", fric_critical_angle, 2};
+        out[1] = {"mu", fric_mu, 2};
+        out[2] = {"lag_ms", fric_onset_lag_ms, 1, true};
+        return 3;
     }
-}
+
+private:
+    const Point& back(size_t k) const { return history[(histHead + HISTORY - 1 - k) % HISTORY]; }
+
+    static void track(float x, float& mean, float& var) {
+        mean += 0.01f * (x - mean);
+        var += 0.01f * ((x - mean) * (x - mean) - var);
+    }
+
+    // tilt: الميل حول Y من خدمة الاتجاه (جيروسكوب + تسارع)، لا يتأثر بالتسارع الخطي قصير المدى
+    void step(const Sample& s, float tilt) {
+        if (!havePrev) {
+            havePrev = true;
+            prevT = s.t_us; prevA[0] = s.ax; prevA[1] = s.ay; prevA[2] = s.az;
+            gyroEma[0] = s.gx; gyroEma[1] = s.gy; gyroEma[2] = s.gz;
+            return;
+        }
+        float dt = (float)(int32_t)(s.t_us - prevT) / 1e6f;
+        if (dt <= 0) return;
+
+        fric_current_angle = tilt;
+
+        float dx = s.ax - prevA[0], dy = s.ay - prevA[1], dz = s.az - prevA[2];
+        float jerk = sqrtf(dx*dx + dy*dy + dz*dz) / dt; // g/s
+        float ex = s.gx - gyroEma[0], ey = s.gy - gyroEma[1], ez = s.gz - gyroEma[2];
+        float gyroDev = sqrtf(ex*ex + ey*ey + ez*ez);
+        const float g[3] = {s.gx, s.gy, s.gz};
+        for (int a = 0; a < 3; a++) gyroEma[a] += 0.02f * (g[a] - gyroEma[a]);
+        prevT = s.t_us; prevA[0] = s.ax; prevA[1] = s.ay; prevA[2] = s.az;
+
+        history[histHead] = {s.t_us, tilt, jerk, gyroDev};
+        histHead = (histHead + 1) % HISTORY;
+        if (histCount < HISTORY) histCount++;
+
+        // في السكون على السطح المائل: ax = g0x - sin(الميل). أي فرق ثابت = تسارع على طول المنحدر
+        float residual = fabsf(s.ax - fric_g0_x + sinf(tilt * PI / 180.0f));
+        if (residual < 0.25f * FRIC_SLIP_THRESHOLD) { track(jerk, jerkMean, jerkVar); track(gyroDev, gyroMean, gyroVar); }
+        slipCount = residual > FRIC_SLIP_THRESHOLD ? slipCount + 1 : 0;
+        if (slipCount >= FRIC_SLIP_CONFIRM_SAMPLES) slip();
+    }
+
+    // الانزلاق مؤكد: نرجع من أول عينة تجاوزت العتبة ما دامت الهزة أو الجيروسكوب
+    // فوق مستوى الإمالة الهادئة، حتى نجد FRIC_QUIET_SAMPLES عينات هادئة متتالية
+    void slip() {
+        float jerkLim = jerkMean + FRIC_ONSET_SIGMA * sqrtf(jerkVar);
+        float gyroLim = gyroMean + FRIC_ONSET_SIGMA * sqrtf(gyroVar);
+        size_t onset = (size_t)slipCount - 1;
+        if (onset >= histCount) onset = histCount - 1;
+        int quiet = 0;
+        for (size_t k = onset + 1; k < histCount && quiet < FRIC_QUIET_SAMPLES; k++) {
+            if (back(k).jerk > jerkLim || back(k).gyroDev > gyroLim) { onset = k; quiet = 0; }
+            else quiet++;
+        }
+        // الزاوية من العينة السابقة مباشرة لبداية الانزلاق
+        const Point& before = back(onset + 1 < histCount ? onset + 1 : onset);
+        fric_critical_angle = fabsf(before.angle);
+        fric_mu = tanf(fric_critical_angle * PI / 180.0f);
+        fric_onset_lag_ms = (float)(int32_t)(back(0).t_us - back(onset).t_us) / 1000.0f;
+        experimentState = DONE;
+        Capture::trigger(back(onset).t_us, "slip");
+        Sound::trigger(Sound::Event::FrictionSlip);
+        Sound::trigger(Sound::Event::ExperimentDone);
+        showDone();
+    }
+};
+
+ProjectileExperiment projectileExperiment;
+PendulumExperiment pendulumExperiment;
+FreefallExperiment freefallExperiment;
+FrictionExperiment frictionExperiment;
+Engine::Registrar projectileReg(&projectileExperiment);
+Engine::Registrar pendulumReg(&pendulumExperiment);
+Engine::Registrar freefallReg(&freefallExperiment);
+Engine::Registrar frictionReg(&frictionExperiment);
+
+} // namespace
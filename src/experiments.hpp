@@ -1,7 +1,9 @@
 // experiments.hpp - فصل منطق التجارب والمتغيرات الخاصة بها
 #pragma once
 
-#include <Arduino.h>
+#include "hal.hpp"
+#include "filters.hpp"
+#include "trajectory.hpp"
 
 // الجاذبية القياسية (تستخدم في الحسابات)
 extern const float GRAVITY_CONST;
@@ -13,18 +15,19 @@ enum ExperimentState { IDLE, WAITING, RUNNING, DONE };
 // الحالة العامة الجارية
 extern ExperimentType activeExperiment;
 extern ExperimentState experimentState;
+// تنعيم التسارع المشترك بين التجارب (يُصفَّر مع كل إعادة لجلسة مسجلة)
+extern KalmanFilter3 accelFilter;
 
 // -----------------------------
 // متغيرات تجربة المقذوفات
 // -----------------------------
-extern float proj_g0, proj_mass, proj_velocity, proj_height;
+extern float proj_g0, proj_mass;
 extern unsigned long proj_time_us;
-extern float proj_V0, proj_T, proj_h_max, proj_g_exp, proj_F_max;
+extern float proj_V0, proj_T, proj_h_max, proj_g_exp, proj_F_max; // proj_V0: المركبة الرأسية
 extern float proj_angle_deg; 
 extern bool proj_freefall_started;
 extern int  proj_landing_samples_count;
-extern float proj_g_sum; 
-extern int  proj_g_samples;
+extern Trajectory proj_trajectory; // الرمية كاملة؛ يعاد بناء المسار منها عند DONE
 extern const float PROJ_THROW_DETECT_THRESHOLD, PROJ_FREEFALL_DETECT_THRESHOLD, PROJ_LANDING_DETECT_THRESHOLD;
 extern const int   PROJ_LANDING_SAMPLES_REQUIRED;
 
@@ -34,15 +37,16 @@ extern const int   PROJ_LANDING_SAMPLES_REQUIRED;
 extern float pend_period, pend_frequency, pend_string_length, pend_g_exp;
 extern int   pend_oscillations_to_measure;
 extern int   pend_oscillation_count;
-extern unsigned long pend_startTime;
-extern bool  pend_isSwinging;
+extern float pend_period_err, pend_confidence; // عدم اليقين (ث) والثقة 0..1 لتقدير الزمن الدوري
 extern float pend_g0_y; 
 extern const float PEND_SWING_THRESHOLD;
+extern const float PEND_CROSSING_HYSTERESIS, PEND_EARLY_STOP_REL_ERR;
 
 // -----------------------------
 // متغيرات تجربة السقوط الحر
 // -----------------------------
 extern float freefall_distance, freefall_time, freefall_g_exp;
+extern float freefall_time_err, freefall_g_err; // الانحراف المعياري للزمن (ث) ولـ g
 extern unsigned long freefall_start_time;
 extern const float FREEFALL_DETECT_THRESHOLD; 
 extern const float FREEFALL_IMPACT_THRESHOLD; 
@@ -53,15 +57,15 @@ extern const float FREEFALL_IMPACT_THRESHOLD;
 extern float fric_g0_x, fric_g0_z;
 extern float fric_current_angle, fric_critical_angle, fric_mu;
 extern float fric_zero_angle;
-extern const float FRIC_SLIP_THRESHOLD;
+extern float fric_onset_lag_ms; // بين بداية الانزلاق الفعلية ولحظة تأكيده (مللي ثانية)
+// FRIC_SLIP_THRESHOLD: تسارع على طول المنحدر (g) يؤكد الانزلاق إذا استمر FRIC_SLIP_CONFIRM_SAMPLES عينة
+extern const float FRIC_SLIP_THRESHOLD, FRIC_ONSET_SIGMA;
+extern const int   FRIC_SLIP_CONFIRM_SAMPLES, FRIC_QUIET_SAMPLES;
 
 // -----------------------------
 // واجهة الدوال
+// التجارب الأربع مسجلة في محرك التجارب (engine.hpp) وتعالج العينات على دفعات
 // -----------------------------
-void projectileController();
-void pendulumController();
-void freefallController();
-void frictionController();
 
 // إعادة ضبط المتغيرات الخاصة بالتجارب فقط
 void resetExperimentData();
@@ -1,4 +1,6 @@
 #pragma once
+#include <math.h>
+#include <stddef.h>
 
 // Kalman 1D simple filter used to smooth accelerometer readings.
 // Tunable parameters Q (process noise) and R (measurement noise).
@@ -27,3 +29,161 @@ public:
         return X;
     }
 };
+
+// Three-axis variant of KalmanFilter with the axes stored struct-of-arrays
+// and stepped together. With steady-state mode enabled, once P has converged
+// to the Riccati fixed point the precomputed constant gain is used and the
+// hot path is one multiply-add per axis (no division, no covariance update).
+class KalmanFilter3 {
+private:
+    float Q, R;
+    float P[3];
+    float X[3];
+    float K[3];
+    float Kss;          // steady-state gain for the current Q/R
+    float Pss;          // steady-state prior covariance
+    bool steadyEnabled;
+    bool steady;
+
+    void computeSteadyState() {
+        // Fixed point of P = P*R/(P+R) + Q  ->  P^2 - Q*P - Q*R = 0
+        Pss = 0.5f * (Q + sqrtf(Q * Q + 4.0f * Q * R));
+        Kss = Pss / (Pss + R);
+    }
+
+public:
+    KalmanFilter3(float q = 0.01f, float r = 0.1f, bool steadyState = true)
+        : Q(q), R(r), steadyEnabled(steadyState), steady(false) {
+        computeSteadyState();
+        reset();
+    }
+
+    inline void setTuning(float q, float r) { Q = q; R = r; computeSteadyState(); steady = false; }
+    inline void setSteadyState(bool enabled) { steadyEnabled = enabled; if (!enabled) steady = false; }
+    inline bool isSteady() const { return steady; }
+    inline float value(int axis) const { return X[axis]; }
+
+    inline void reset(float x = 0.0f, float y = 0.0f, float z = 0.0f) {
+        X[0] = x; X[1] = y; X[2] = z;
+        for (int i = 0; i < 3; i++) { P[i] = 0.1f; K[i] = 0.0f; }
+        steady = false;
+    }
+
+    // One xyz measurement in, filtered xyz out (in and out may alias).
+    inline void update(const float* m, float* out) {
+        if (steady) {
+            for (int i = 0; i < 3; i++) out[i] = X[i] = X[i] + Kss * (m[i] - X[i]);
+            return;
+        }
+        for (int i = 0; i < 3; i++) {
+            K[i] = P[i] / (P[i] + R);
+            X[i] = X[i] + K[i] * (m[i] - X[i]);
+            P[i] = (1 - K[i]) * P[i] + Q;
+            out[i] = X[i];
+        }
+        // All axes share Q/R and P0, so checking one axis is enough.
+        if (steadyEnabled && fabsf(P[0] - Pss) <= 1e-4f * Pss) {
+            steady = true;
+            for (int i = 0; i < 3; i++) { P[i] = Pss; K[i] = Kss; }
+        }
+    }
+
+    // Batch update over n interleaved xyz frames (in[3*n], out[3*n]).
+    // In steady state the three estimates stay in registers across the whole
+    // batch and each sample costs three multiply-adds.
+    void update(const float* in, float* out, size_t n) {
+        size_t i = 0;
+        while (!steady && i < n) { update(in + 3 * i, out + 3 * i); i++; }
+        if (i == n) return;
+        float x0 = X[0], x1 = X[1], x2 = X[2];
+        const float k = Kss;
+        const float* m = in + 3 * i;
+        float* o = out + 3 * i;
+        for (; i < n; i++, m += 3, o += 3) {
+            x0 += k * (m[0] - x0);
+            x1 += k * (m[1] - x1);
+            x2 += k * (m[2] - x2);
+            o[0] = x0; o[1] = x1; o[2] = x2;
+        }
+        X[0] = x0; X[1] = x1; X[2] = x2;
+    }
+};
+
+// Mahony complementary filter on the unit quaternion (6-DOF: gyro + accel).
+// The accelerometer pulls the estimated "up" vector towards the measured one
+// with a PI controller; while the measured norm is far from 1 g (throw,
+// free fall, impact) the correction is skipped and the gyro is integrated
+// alone. Every update costs the same arithmetic, with one inverse square root
+// for the accel and one for the quaternion.
+class MahonyFilter {
+private:
+    float Kp, Ki;
+    float q0, q1, q2, q3;
+    float ix, iy, iz;   // integral feedback (slow gyro bias), rad/s
+
+    static inline float invSqrt(float x) { return 1.0f / sqrtf(x); }
+
+public:
+    MahonyFilter(float kp = 1.0f, float ki = 0.02f) : Kp(kp), Ki(ki) { reset(); }
+
+    inline void setGains(float kp, float ki) { Kp = kp; Ki = ki; }
+
+    inline void reset() {
+        q0 = 1.0f; q1 = q2 = q3 = 0.0f;
+        ix = iy = iz = 0.0f;
+    }
+
+    // Start from the attitude implied by one accel reading (yaw = 0), so no
+    // convergence time is needed after boot.
+    void align(float ax, float ay, float az) {
+        float roll = atan2f(ay, az);
+        float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+        float cr = cosf(0.5f * roll), sr = sinf(0.5f * roll);
+        float cp = cosf(0.5f * pitch), sp = sinf(0.5f * pitch);
+        q0 = cr * cp; q1 = sr * cp; q2 = cr * sp; q3 = -sr * sp;
+        ix = iy = iz = 0.0f;
+    }
+
+    // Gyro in rad/s, accel in g, dt in seconds.
+    inline void update(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+        float n2 = ax * ax + ay * ay + az * az;
+        if (n2 > 0.25f && n2 < 2.25f) {
+            float r = invSqrt(n2);
+            ax *= r; ay *= r; az *= r;
+            float vx, vy, vz;
+            up(vx, vy, vz);
+            // Error = measured x estimated gravity direction
+            float ex = ay * vz - az * vy;
+            float ey = az * vx - ax * vz;
+            float ez = ax * vy - ay * vx;
+            ix += Ki * ex * dt; iy += Ki * ey * dt; iz += Ki * ez * dt;
+            gx += Kp * ex + ix; gy += Kp * ey + iy; gz += Kp * ez + iz;
+        } else {
+            gx += ix; gy += iy; gz += iz;
+        }
+        float h = 0.5f * dt;
+        float a0 = q0, a1 = q1, a2 = q2;
+        q0 += h * (-a1 * gx - a2 * gy - q3 * gz);
+        q1 += h * ( a0 * gx + a2 * gz - q3 * gy);
+        q2 += h * ( a0 * gy - a1 * gz + q3 * gx);
+        q3 += h * ( a0 * gz + a1 * gy - a2 * gx);
+        float r = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+        q0 *= r; q1 *= r; q2 *= r; q3 *= r;
+    }
+
+    // World "up" expressed in the body frame: what the accelerometer reads at rest.
+    inline void up(float& x, float& y, float& z) const {
+        x = 2.0f * (q1 * q3 - q0 * q2);
+        y = 2.0f * (q0 * q1 + q2 * q3);
+        z = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+    }
+
+    // Rotate a body-frame vector into the world frame (z up).
+    inline void toWorld(const float* b, float* w) const {
+        w[0] = (q0*q0 + q1*q1 - q2*q2 - q3*q3) * b[0] + 2.0f * (q1*q2 - q0*q3) * b[1] + 2.0f * (q1*q3 + q0*q2) * b[2];
+        w[1] = 2.0f * (q1*q2 + q0*q3) * b[0] + (q0*q0 - q1*q1 + q2*q2 - q3*q3) * b[1] + 2.0f * (q2*q3 - q0*q1) * b[2];
+        w[2] = 2.0f * (q1*q3 - q0*q2) * b[0] + 2.0f * (q0*q1 + q2*q3) * b[1] + (q0*q0 - q1*q1 - q2*q2 + q3*q3) * b[2];
+    }
+
+    inline void quaternion(float* q) const { q[0] = q0; q[1] = q1; q[2] = q2; q[3] = q3; }
+};
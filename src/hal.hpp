@@ -0,0 +1,41 @@
+// hal.hpp - طبقة العتاد: الساعة وشاشة الحالة والسماعة (مصدر IMU هو واجهة Sampler)
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// التجارب والمحرك والفلاتر ومُسلسِل الصوت تصل إلى العتاد عبر هذه الواجهة فقط،
+// فتُبنى كما هي للجهاز (hal_m5.cpp) وللحاسوب (native/، بيئة native مع HAL_NATIVE).
+#ifdef HAL_NATIVE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#else
+#include <Arduino.h>
+#endif
+
+namespace Hal {
+  // الساعة. على الحاسوب ساعة افتراضية يقدّمها مصدر العينات إلى ختم آخر عينة،
+  // فالإعادة تعمل بأسرع ما يمكن مع بقاء المهل (إعادة التسليح، الأصوات) بزمن العينات
+  uint32_t millis();
+  uint32_t micros();
+#ifdef HAL_NATIVE
+  void setMicros(uint32_t us);
+#endif
+
+  // شاشة حالة: تملأ الشاشة باللون وتكتب النص في منتصفها
+  enum class Color : uint8_t { Blue, DarkGreen, Orange, Teal };
+  void showStatus(Color color, const char* text);
+
+  // السماعة: نغمة مستمرة حتى toneStop (المدد يديرها مُسلسِل Sound)
+  void tone(uint16_t freqHz);
+  void toneStop();
+
+  // ذاكرة كبيرة من PSRAM؛ nullptr إن لم تتوفر (والبديل على المستدعي)
+  void* psramAlloc(size_t bytes);
+}
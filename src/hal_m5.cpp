@@ -0,0 +1,35 @@
+// hal_m5.cpp - طبقة العتاد على M5StickC Plus2
+#include "hal.hpp"
+#include <M5Unified.h>
+
+// لون مخصص (ليس من ألوان M5GFX)
+#define TEAL 0x0438
+
+namespace Hal {
+  uint32_t millis() { return ::millis(); }
+  uint32_t micros() { return ::micros(); }
+
+  void showStatus(Color color, const char* text) {
+    uint16_t c = BLUE;
+    switch (color) {
+      case Color::Blue: c = BLUE; break;
+      case Color::DarkGreen: c = DARKGREEN; break;
+      case Color::Orange: c = ORANGE; break;
+      case Color::Teal: c = TEAL; break;
+    }
+    M5.Display.fillScreen(c);
+    M5.Display.setCursor(0, 80);
+    M5.Display.println(text);
+  }
+
+  void tone(uint16_t freqHz) {
+    M5.Speaker.setVolume(255);
+    M5.Speaker.tone(freqHz);
+  }
+
+  void toneStop() { M5.Speaker.stop(); }
+
+  void* psramAlloc(size_t bytes) {
+    return psramFound() ? ps_malloc(bytes) : nullptr;
+  }
+}
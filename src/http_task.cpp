@@ -0,0 +1,84 @@
+// http_task.cpp - تنفيذ مهمة HTTP وجسر الأوامر/اللقطة مع loop()
+#include "http_task.hpp"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+namespace {
+  struct Command {
+    HttpTask::LoopFn fn;
+    void* ctx;
+  };
+
+  TaskHandle_t task = nullptr;
+  void (*pollFn)() = nullptr;
+  QueueHandle_t commands = nullptr;
+  SemaphoreHandle_t commandDone = nullptr; // مهمة HTTP واحدة تنتظر أمراً واحداً في كل مرة
+  uint32_t bootId = 0; // يميز ETag اللقطات بين مرات الإقلاع
+
+  void run(void*) {
+    for (;;) {
+      pollFn();
+      vTaskDelay(1);
+    }
+  }
+}
+
+namespace HttpTask {
+  Snapshot results;
+  Snapshot battery;
+
+  Snapshot::Snapshot() : lock(xSemaphoreCreateMutex()), len(2), ver(0) {
+    memcpy(buf, "{}", 3);
+  }
+
+  void Snapshot::publish(const char* json, size_t n) {
+    if (n >= SNAPSHOT_MAX) return;
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (n != len || memcmp(json, buf, n) != 0) {
+      memcpy(buf, json, n);
+      buf[n] = '\0';
+      len = n;
+      ver++;
+    }
+    xSemaphoreGive(lock);
+  }
+
+  size_t Snapshot::copy(char* out, size_t cap, uint32_t* version) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    size_t n = len < cap ? len : 0;
+    memcpy(out, buf, n);
+    if (cap) out[n] = '\0';
+    if (version) *version = ver;
+    xSemaphoreGive(lock);
+    return n;
+  }
+
+  void Snapshot::etag(char* out, size_t cap, uint32_t version) const {
+    snprintf(out, cap, "\"%08x-%u\"", (unsigned)bootId, (unsigned)version);
+  }
+
+  void begin(void (*poll)()) {
+    if (task) return;
+    pollFn = poll;
+    bootId = esp_random();
+    commands = xQueueCreate(4, sizeof(Command));
+    commandDone = xSemaphoreCreateBinary();
+    xTaskCreatePinnedToCore(run, "http", STACK, nullptr, PRIORITY, &task, CORE);
+  }
+
+  void callOnLoop(LoopFn fn, void* ctx) {
+    if (!task) { fn(ctx); return; } // قبل بدء المهمة (setup) نحن على loop أصلاً
+    Command c = {fn, ctx};
+    xQueueSend(commands, &c, portMAX_DELAY);
+    xSemaphoreTake(commandDone, portMAX_DELAY);
+  }
+
+  void service() {
+    if (!commands) return;
+    Command c;
+    while (xQueueReceive(commands, &c, 0) == pdTRUE) {
+      c.fn(c.ctx);
+      xSemaphoreGive(commandDone);
+    }
+  }
+}
@@ -0,0 +1,50 @@
+// http_task.hpp - خادم HTTP في مهمة FreeRTOS مستقلة عن loop() وعن أولوية أخذ العينات
+#pragma once
+
+#include <Arduino.h>
+#include "freertos/semphr.h"
+
+namespace HttpTask {
+  // النواة 0 بأولوية أدنى من Sampler (5): حركة الويب لا تؤخر عينة،
+  // ولا تشارك loop() (النواة 1) حيث تجري المعايرة والكشف
+  const BaseType_t CORE = 0;
+  const UBaseType_t PRIORITY = 1;
+  const uint32_t STACK = 8192;
+  // أقصى طول للقطة (مخزن ثابت، بلا حجز من الكومة)
+  const size_t SNAPSHOT_MAX = 1024;
+
+  // رد JSON جاهز تنشره loop() وتقرؤه مهمة HTTP، مع رقم إصدار يزيد عند تغير المحتوى فقط.
+  // الرد المخزن يُرسل كما هو لكل طلب، و ETag المشتق من الإصدار يسمح بالرد 304
+  class Snapshot {
+  public:
+    Snapshot();
+    void publish(const char* json, size_t len);
+    // ينسخ الرد إلى out ويرجع طوله (0 إن لم يتسع)
+    size_t copy(char* out, size_t cap, uint32_t* version = nullptr);
+    uint32_t version() const { return ver; }
+    // "<رقم الإقلاع>-<الإصدار>" بعلامتي التنصيص: لا يتطابق مع ETag من إقلاع سابق
+    void etag(char* out, size_t cap, uint32_t version) const;
+
+  private:
+    SemaphoreHandle_t lock;
+    char buf[SNAPSHOT_MAX];
+    size_t len;
+    volatile uint32_t ver;
+  };
+
+  extern Snapshot results; // بصيغة /results
+  extern Snapshot battery; // بصيغة /battery
+
+  // يبدأ المهمة: تستدعي poll() باستمرار (handleClient، DNS، قنوات الدفع)
+  void begin(void (*poll)());
+
+  // ---- جهة مهمة HTTP ----
+  // ينفذ fn(ctx) على loop() وينتظر انتهاءه. كل ما يقرأ أو يغير حالة التجارب
+  // (Engine، الشاشة، الالتقاط، المعايرة) يمر من هنا بدل لمس المتغيرات مباشرة
+  typedef void (*LoopFn)(void* ctx);
+  void callOnLoop(LoopFn fn, void* ctx);
+
+  // ---- جهة loop() ----
+  // ينفذ الأوامر المنتظرة؛ يُستدعى في كل دورة
+  void service();
+}
@@ -0,0 +1,172 @@
+#pragma once
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Streaming JSON serializer into a caller-owned fixed buffer. Never touches the
+// heap: commas are inserted from a small nesting stack, numbers are formatted
+// with integer arithmetic (no printf/dtoa), and running out of room sets a
+// sticky overflow flag instead of growing. Output stays NUL-terminated.
+class JsonWriter {
+private:
+    static const uint8_t MAX_DEPTH = 8;
+
+    char* buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+    uint8_t depth;
+    uint8_t first;      // bit d set: nothing written yet at nesting level d
+    bool afterKey;
+
+    inline void put(char c) {
+        if (overflow) return;
+        if (len + 1 < cap) { buf[len++] = c; buf[len] = '\0'; }
+        else overflow = true;
+    }
+
+    inline void put(const char* s, size_t n) {
+        if (overflow) return;
+        if (len + n < cap) { memcpy(buf + len, s, n); len += n; buf[len] = '\0'; }
+        else overflow = true;
+    }
+
+    // Separator before a value or key; values that follow a key need none.
+    inline void separate() {
+        if (afterKey) { afterKey = false; return; }
+        uint8_t bit = 1 << depth;
+        if (first & bit) first &= ~bit;
+        else put(',');
+    }
+
+    inline void open(char c) {
+        separate();
+        put(c);
+        if (depth + 1 < MAX_DEPTH) depth++;
+        else overflow = true;
+        first |= 1 << depth;
+    }
+
+    inline void close(char c) {
+        if (depth) depth--;
+        afterKey = false;
+        put(c);
+    }
+
+    void putEscaped(const char* s) {
+        static const char HEX_DIGITS[] = "0123456789abcdef";
+        for (; *s; s++) {
+            unsigned char c = (unsigned char)*s;
+            if (c == '"' || c == '\\') { put('\\'); put((char)c); }
+            else if (c == '\n') put("\\n", 2);
+            else if (c == '\r') put("\\r", 2);
+            else if (c == '\t') put("\\t", 2);
+            else if (c < 0x20) { put("\\u00", 4); put(HEX_DIGITS[c >> 4]); put(HEX_DIGITS[c & 15]); }
+            else put((char)c);
+        }
+    }
+
+    void putUnsigned(uint64_t v) {
+        char tmp[20];
+        size_t n = 0;
+        do { tmp[n++] = (char)('0' + v % 10); v /= 10; } while (v);
+        while (n) put(tmp[--n]);
+    }
+
+public:
+    JsonWriter(char* buffer, size_t capacity) : buf(buffer), cap(capacity) { reset(); }
+
+    inline void reset() {
+        len = 0; overflow = cap == 0; depth = 0; first = 1; afterKey = false;
+        if (cap) buf[0] = '\0';
+    }
+
+    inline JsonWriter& beginObject() { open('{'); return *this; }
+    inline JsonWriter& endObject() { close('}'); return *this; }
+    inline JsonWriter& beginArray() { open('['); return *this; }
+    inline JsonWriter& endArray() { close(']'); return *this; }
+
+    inline JsonWriter& key(const char* k) {
+        separate();
+        put('"'); putEscaped(k); put('"'); put(':');
+        afterKey = true;
+        return *this;
+    }
+
+    inline JsonWriter& value(const char* s) {
+        separate();
+        put('"'); putEscaped(s); put('"');
+        return *this;
+    }
+
+    inline JsonWriter& value(bool b) {
+        separate();
+        if (b) put("true", 4); else put("false", 5);
+        return *this;
+    }
+
+    // Overloads on the fundamental types so that size_t/uint32_t resolve the
+    // same way on the device and on a 64-bit host.
+    inline JsonWriter& value(long long v) {
+        separate();
+        if (v < 0) { put('-'); putUnsigned(0 - (uint64_t)v); }
+        else putUnsigned((uint64_t)v);
+        return *this;
+    }
+
+    inline JsonWriter& value(unsigned long long v) { separate(); putUnsigned(v); return *this; }
+    inline JsonWriter& value(int v) { return value((long long)v); }
+    inline JsonWriter& value(long v) { return value((long long)v); }
+    inline JsonWriter& value(unsigned v) { return value((unsigned long long)v); }
+    inline JsonWriter& value(unsigned long v) { return value((unsigned long long)v); }
+
+    // Fixed-point with `decimals` digits (0..6), rounded half away from zero.
+    // NaN/inf have no JSON spelling and are written as null, as are values beyond 2^32.
+    JsonWriter& value(float v, uint8_t decimals) {
+        separate();
+        char tmp[FLOAT_CHARS];
+        size_t n = formatFloat(tmp, v, decimals);
+        if (n) put(tmp, n); else put("null", 4);
+        return *this;
+    }
+
+    // Longest text formatFloat can produce: sign, 10 integer digits, point, 6 decimals.
+    static const size_t FLOAT_CHARS = 18;
+
+    // The number formatter on its own, for other text formats (CSV export).
+    // Writes at most FLOAT_CHARS bytes, no terminator; returns 0 when v is not
+    // representable. Integer and fraction are split first so the common path
+    // stays in single precision (double is emulated in software on the ESP32).
+    static size_t formatFloat(char* out, float v, uint8_t decimals) {
+        float a = fabsf(v);
+        if (!(a < 4294967040.0f)) return 0;
+        if (decimals > 6) decimals = 6;
+        uint32_t scale = 1;
+        for (uint8_t i = 0; i < decimals; i++) scale *= 10;
+        uint32_t ip = (uint32_t)a;
+        uint32_t frac = (uint32_t)((a - (float)ip) * scale + 0.5f);
+        if (frac >= scale) { ip++; frac -= scale; }
+        size_t n = 0;
+        if (v < 0 && (ip || frac)) out[n++] = '-';
+        char tmp[10];
+        size_t k = 0;
+        do { tmp[k++] = (char)('0' + ip % 10); ip /= 10; } while (ip);
+        while (k) out[n++] = tmp[--k];
+        if (decimals) {
+            out[n++] = '.';
+            for (uint32_t d = scale / 10; d; d /= 10) { out[n++] = (char)('0' + frac / d); frac %= d; }
+        }
+        return n;
+    }
+
+    // key/value in one call
+    template <typename T>
+    inline JsonWriter& field(const char* k, T v) { return key(k).value(v); }
+    inline JsonWriter& field(const char* k, float v, uint8_t decimals) { return key(k).value(v, decimals); }
+
+    inline const char* c_str() const { return buf; }
+    inline size_t length() const { return len; }
+    // True once anything was dropped; the text is then incomplete and must not be sent.
+    inline bool overflowed() const { return overflow; }
+};
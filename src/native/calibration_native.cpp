@@ -0,0 +1,16 @@
+// calibration_native.cpp - المعايرة على الحاسوب: المدخلات مصححة مسبقاً (أو تركيبية)
+#include "calibration.hpp"
+
+// إزاحات السكون (proj_g0 وغيرها) يضبطها السائق مباشرة قبل بدء التجربة
+namespace Calibration {
+  bool load() { return true; }
+  void startRest() {}
+  void startSixPosition() {}
+  State state() { return State::Idle; }
+  uint8_t positionsDone() { return 0; }
+  bool hasProfile() { return false; }
+  float profileTemperature() { return NAN; }
+  bool takeFinished() { return false; }
+  void feed(const Sample* samples, size_t n) { (void)samples; (void)n; }
+  void apply(Sample* samples, size_t n) { (void)samples; (void)n; }
+}
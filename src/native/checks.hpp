@@ -0,0 +1,16 @@
+// checks.hpp - فحوص الحاسوب للمكونات المشتركة مع الجهاز (أوامر فرعية في برنامج native)
+#pragma once
+
+namespace Checks {
+  // program codec [-n ROUNDS] [--dump FILE]
+  // كتل TraceCodec عشوائية ترمَّز وتُفك وتُقارن، ونسخ ناقصة وتالفة منها يجب أن تُرفض،
+  // ثم السرعة والبايتات لكل إطار على مسار يحاكي ضجيج الحساس (--dump يحفظه إطارات خاماً).
+  // رمز الخروج 1 عند أي خطأ
+  int codec(int argc, char** argv);
+
+  // program json [-n ROUNDS]
+  // بناء رد /results بـ JsonWriter وبسلاسل std::string (بديل String على الحاسوب):
+  // البايتات/ث وعدد عمليات الحجز وحجمها لكل بناء عبر operator new مستبدل.
+  // رمز الخروج 1 إن حجز JsonWriter شيئاً أو اختلف النصان
+  int json(int argc, char** argv);
+}
@@ -0,0 +1,181 @@
+// codec_check.cpp - فحص TraceCodec على الحاسوب: كتل عشوائية بحالاتها الحدية، ورفض
+// الكتل الناقصة والتالفة، ثم السرعة ونسبة الضغط على مسار يحاكي الحساس
+#include <chrono>
+#include "checks.hpp"
+#include "tap.hpp"
+
+namespace {
+  using TraceCodec::Frame;
+
+  // xorshift32 ثابت البذرة: كل تشغيل يفحص الكتل نفسها
+  uint32_t state = 2463534242u;
+  uint32_t next() {
+    state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+    return state;
+  }
+
+  int16_t extreme() {
+    static const int16_t VALUES[] = {32767, -32768, 0, -1, 1};
+    return VALUES[next() % 5];
+  }
+
+  void setChannel(Frame& f, size_t c, int16_t v) {
+    if (c < 3) f.a[c] = v;
+    else f.g[c - 3] = v;
+  }
+
+  // كل قناة بنمط مستقل: ثابتة (0 بت)، عشوائية بكامل المدى، تناوب بين الطرفين
+  // (أعرض فرق: 17 بتاً)، أو مشي صغير حول قيمة عشوائية
+  void fillChannel(Frame* f, size_t n, size_t c) {
+    uint32_t mode = next() % 4;
+    int32_t v = next() % 2 ? extreme() : (int16_t)next();
+    for (size_t i = 0; i < n; i++) {
+      if (mode == 1) v = (int16_t)next();
+      else if (mode == 2) v = i % 2 ? 32767 : -32768;
+      else if (mode == 3) {
+        v += (int32_t)(next() % 65) - 32;
+        v = v > 32767 ? 32767 : (v < -32768 ? -32768 : v);
+      }
+      setChannel(f[i], c, (int16_t)v);
+    }
+  }
+
+  // الأختام: منتظمة بارتعاش، أو فجوات عشوائية بكامل مدى uint32 (تشمل الرجوع للخلف)،
+  // أو منتظمة تعبر الالتفاف عند 2^32، أو متساوية (فاصل صفر)
+  void fillTime(Frame* f, size_t n) {
+    uint32_t mode = next() % 4;
+    uint32_t t = mode == 2 ? 0xFFFFFFFFu - (next() % (n * 2000)) : next();
+    for (size_t i = 0; i < n; i++) {
+      f[i].t_us = t;
+      if (mode == 0 || mode == 2) t += 2000 + next() % 5 - 2;
+      else if (mode == 1) t += next();
+    }
+  }
+
+  // مسار يحاكي MPU6886 عند 500Hz: حركة يد بطيئة (جيبان لكل محور) + ضجيج أبيض قريب
+  // من ورقة البيانات (~1.5 mg و ~0.05 درجة/ث RMS) + ارتعاش ±2 µs في الأختام، مكمّماً
+  // بـ Tap::toFrame كما يُسجَّل على الجهاز
+  float gaussian() {
+    float u1 = (next() + 1.0f) / 4294967296.0f, u2 = next() / 4294967296.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)PI * u2);
+  }
+
+  void sensorTrace(Frame* out, size_t n) {
+    state = 2463534242u; // المسار نفسه أياً كان عدد جولات الفحص قبله
+    uint32_t t = 1000000;
+    const float A_NOISE = 0.0015f, G_NOISE = 0.05f;
+    for (size_t i = 0; i < n; i++) {
+      float s = i / 500.0f, w = 2.0f * (float)PI;
+      Sample x;
+      x.t_us = t;
+      x.ax = 0.20f * sinf(w * 0.7f * s) + A_NOISE * gaussian();
+      x.ay = 0.15f * sinf(w * 0.4f * s + 1.0f) + A_NOISE * gaussian();
+      x.az = 1.0f + 0.10f * sinf(w * 1.1f * s) + A_NOISE * gaussian();
+      x.gx = 20.0f * sinf(w * 0.5f * s) + G_NOISE * gaussian();
+      x.gy = 15.0f * cosf(w * 0.8f * s) + G_NOISE * gaussian();
+      x.gz = 10.0f * sinf(w * 0.3f * s) + G_NOISE * gaussian();
+      Tap::toFrame(x, out[i]);
+      t += 2000 + next() % 5 - 2;
+    }
+  }
+
+  const size_t TRACE_FRAMES = 65536;
+  const size_t TRACE_BLOCKS = TRACE_FRAMES / TraceCodec::BLOCK_FRAMES;
+  Frame trace[TRACE_FRAMES], decoded[TRACE_FRAMES];
+  uint8_t packed[TRACE_BLOCKS * TraceCodec::MAX_BLOCK_BYTES];
+
+  size_t encodeTrace() {
+    size_t bytes = 0;
+    for (size_t i = 0; i < TRACE_FRAMES; i += TraceCodec::BLOCK_FRAMES) {
+      bytes += TraceCodec::encodeBlock(trace + i, TRACE_FRAMES - i, packed + bytes);
+    }
+    return bytes;
+  }
+
+  size_t decodeTrace(size_t bytes) {
+    size_t pos = 0, n = 0, used = 0;
+    while (pos < bytes) {
+      size_t k = TraceCodec::decodeBlock(packed + pos, bytes - pos, decoded + n, &used);
+      if (!k) break;
+      pos += used;
+      n += k;
+    }
+    return n;
+  }
+
+  double seconds(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  }
+}
+
+namespace Checks {
+  int codec(int argc, char** argv) {
+    size_t rounds = 100000;
+    const char* dump = nullptr;
+    for (int i = 2; i < argc; i++) {
+      if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) rounds = strtoul(argv[++i], nullptr, 10);
+      else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) dump = argv[++i];
+    }
+
+    // ترميز وفك: الطول 1..64 وحالات القنوات والأختام عشوائية، والطلب فوق 64 يرمّز 64
+    Frame in[TraceCodec::BLOCK_FRAMES + 8], out[TraceCodec::BLOCK_FRAMES];
+    uint8_t block[TraceCodec::MAX_BLOCK_BYTES + 16];
+    size_t roundTrip = 0, truncated = 0, cuts = 0, corrupt = 0, flips = 0;
+    for (size_t r = 0; r < rounds; r++) {
+      size_t n = r == 0 ? TraceCodec::BLOCK_FRAMES + 8 : 1 + next() % TraceCodec::BLOCK_FRAMES;
+      fillTime(in, n);
+      for (size_t c = 0; c < TraceCodec::CHANNELS; c++) fillChannel(in, n, c);
+      size_t expected = n > TraceCodec::BLOCK_FRAMES ? TraceCodec::BLOCK_FRAMES : n;
+
+      size_t bytes = TraceCodec::encodeBlock(in, n, block);
+      // بايتات زائدة بعد الكتلة (الكتلة التالية في الملف) لا تؤثر على فكها
+      for (size_t k = 0; k < 16; k++) block[bytes + k] = (uint8_t)next();
+      size_t used = 0;
+      size_t got = TraceCodec::decodeBlock(block, bytes + 16, out, &used);
+      if (bytes > TraceCodec::MAX_BLOCK_BYTES || got != expected || used != bytes ||
+          memcmp(in, out, expected * sizeof(Frame)) != 0) roundTrip++;
+
+      // كل طول أقصر من الكتلة في أول 1000 جولة، وطول عشوائي بعدها
+      for (size_t k = 0; k < bytes; k++) {
+        size_t cut = r < 1000 ? k : next() % bytes;
+        cuts++;
+        if (TraceCodec::decodeBlock(block, cut, out)) truncated++;
+        if (r >= 1000) break;
+      }
+
+      // قلب بت واحد في أي موضع: يكشفه CRC-8 دائماً
+      size_t bit = next() % (bytes * 8);
+      block[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+      flips++;
+      if (TraceCodec::decodeBlock(block, bytes, out)) corrupt++;
+    }
+    printf("round trip %8u blocks      %u mismatched\n", (unsigned)rounds, (unsigned)roundTrip);
+    printf("truncated  %8u cuts        %u accepted\n", (unsigned)cuts, (unsigned)truncated);
+    printf("corrupt    %8u bit flips   %u accepted\n", (unsigned)flips, (unsigned)corrupt);
+
+    // السرعة بالنسبة لحجم الإطارات الخام (16 بايت)، وحجم المسار المضغوط
+    sensorTrace(trace, TRACE_FRAMES);
+    if (dump) {
+      FILE* f = fopen(dump, "wb");
+      if (!f || fwrite(trace, sizeof(Frame), TRACE_FRAMES, f) != TRACE_FRAMES) { printf("cannot write %s\n", dump); return 2; }
+      fclose(f);
+    }
+    const int REPEAT = 20;
+    size_t bytes = 0, frames = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < REPEAT; k++) bytes = encodeTrace();
+    double enc = seconds(t0);
+    t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < REPEAT; k++) frames = decodeTrace(bytes);
+    double dec = seconds(t0);
+    bool exact = frames == TRACE_FRAMES && memcmp(trace, decoded, sizeof(trace)) == 0;
+    double raw = (double)REPEAT * sizeof(trace) / 1e6;
+    printf("trace      %8u frames      %.2f bytes/frame (%.1fx vs Frame, %.1fx vs Sample)  %s\n",
+           (unsigned)TRACE_FRAMES, (double)bytes / TRACE_FRAMES, (double)sizeof(trace) / bytes,
+           (double)TRACE_FRAMES * sizeof(Sample) / bytes, exact ? "exact" : "MISMATCH");
+    printf("encode     %8.0f MB/s\n", enc > 0 ? raw / enc : 0.0);
+    printf("decode     %8.0f MB/s\n", dec > 0 ? raw / dec : 0.0);
+
+    return (roundTrip || truncated || corrupt || !exact) ? 1 : 0;
+  }
+}
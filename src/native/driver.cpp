@@ -0,0 +1,14 @@
+// driver.cpp - تشغيل المحرك على الحاسوب بدل loop()
+#include "native.hpp"
+#include "engine.hpp"
+
+namespace Native {
+  void play(const Sample* samples, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      inject(samples[i]);
+      if (pending() >= Engine::BATCH_SIZE) { Engine::run(); Sound::update(); }
+    }
+    Engine::run();
+    Sound::update();
+  }
+}
@@ -0,0 +1,36 @@
+// hal_native.cpp - طبقة العتاد على الحاسوب: ساعة افتراضية وشاشة وسماعة تسجلان آخر قيمة
+#include "hal.hpp"
+#include "native.hpp"
+
+namespace {
+  uint32_t nowUs = 0;
+  const char* status = "";
+  Hal::Color statusColor = Hal::Color::Blue;
+  uint16_t toneHz = 0;
+  uint32_t toneCount = 0;
+}
+
+namespace Hal {
+  uint32_t millis() { return nowUs / 1000; }
+  uint32_t micros() { return nowUs; }
+  void setMicros(uint32_t us) { nowUs = us; }
+
+  void showStatus(Color color, const char* text) {
+    statusColor = color;
+    status = text;
+    if (Native::verbose) printf("[%8.3f s] screen: %s\n", nowUs / 1e6, text);
+  }
+
+  void tone(uint16_t freqHz) { toneHz = freqHz; toneCount++; }
+  void toneStop() { toneHz = 0; }
+
+  void* psramAlloc(size_t bytes) { (void)bytes; return nullptr; }
+}
+
+namespace Native {
+  bool verbose = false;
+
+  const char* lastStatus() { return status; }
+  uint16_t currentTone() { return toneHz; }
+  uint32_t tones() { return toneCount; }
+}
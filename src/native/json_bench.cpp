@@ -0,0 +1,125 @@
+// json_bench.cpp - كلفة بناء رد /results على الحاسوب: JsonWriter مقابل بناء بالسلاسل
+// كما كان بـ String، مع عدّ عمليات الحجز عبر operator new
+#include <chrono>
+#include <new>
+#include <string>
+#include "checks.hpp"
+#include "hal.hpp"
+#include "json_writer.hpp"
+
+// استبدال operator new للبرنامج كله: العدادات تُقرأ فرقاً حول كل بناء
+namespace {
+  size_t allocCount = 0, allocBytes = 0;
+}
+
+void* operator new(size_t n) {
+  allocCount++;
+  allocBytes += n;
+  void* p = malloc(n ? n : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+
+namespace {
+  // نفس بيانات /bench على الجهاز: جاذبية + تذبذب + ضجيج (LCG ثابت البذرة)
+  float input[3 * 256];
+  void fillInput() {
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < 3 * 256; i++) {
+      seed = seed * 1664525u + 1013904223u;
+      float noise = ((seed >> 8) & 0xFFFF) / 65535.0f - 0.5f;
+      input[i] = ((i % 3) == 2 ? 1.0f : 0.0f) + 0.3f * sinf(i * 0.01f) + 0.05f * noise;
+    }
+  }
+
+  const char* const KEYS[] = {"v0", "angle", "max_height", "range", "time"};
+  char jsonBuf[1024];
+  volatile size_t sink;
+
+  size_t buildWriter(JsonWriter& w) {
+    w.reset();
+    w.beginObject().field("type", "projectile").field("status", "done");
+    for (size_t i = 0; i < 5; i++) w.field(KEYS[i], input[i] * 10.0f, 2);
+    w.field("trial", 7).field("trials", 10);
+    w.key("stats").beginObject();
+    for (size_t i = 0; i < 4; i++) {
+      w.key(KEYS[i]).beginObject();
+      w.field("n", 7).field("mean", input[i], 3).field("sd", input[i + 3], 3).field("ci95", input[i + 6], 3);
+      w.endObject();
+    }
+    w.endObject().endObject();
+    return w.length();
+  }
+
+  // بديل String على الحاسوب: std::string بالتعبيرات نفسها (كل + ينشئ مؤقتاً وقد يعيد الحجز)
+  std::string str(float v, int decimals) {
+    char tmp[24];
+    snprintf(tmp, sizeof(tmp), "%.*f", decimals, v);
+    return tmp;
+  }
+  std::string str(int v) { return std::to_string(v); }
+
+  std::string buildString() {
+    std::string json = "{\"type\":\"projectile\",\"status\":\"done\"";
+    for (size_t i = 0; i < 5; i++) json += ",\"" + std::string(KEYS[i]) + "\":" + str(input[i] * 10.0f, 2);
+    json += ",\"trial\":" + str(7) + ",\"trials\":" + str(10);
+    json += ",\"stats\":{";
+    for (size_t i = 0; i < 4; i++) {
+      if (i) json += ",";
+      json += "\"" + std::string(KEYS[i]) + "\":{\"n\":" + str(7);
+      json += ",\"mean\":" + str(input[i], 3);
+      json += ",\"sd\":" + str(input[i + 3], 3);
+      json += ",\"ci95\":" + str(input[i + 6], 3) + "}";
+    }
+    json += "}}";
+    return json;
+  }
+
+  struct Cost {
+    size_t bytes;
+    double bytesPerSec;
+    size_t allocs, allocated; // لكل بناء
+  };
+
+  template <typename Build>
+  Cost measure(size_t rounds, Build build) {
+    Cost c;
+    size_t count0 = allocCount, bytes0 = allocBytes;
+    c.bytes = build();
+    c.allocs = allocCount - count0;
+    c.allocated = allocBytes - bytes0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; r++) sink = build();
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    c.bytesPerSec = s > 0 ? (double)c.bytes * rounds / s : 0.0;
+    return c;
+  }
+
+  void print(const char* name, const Cost& c) {
+    printf("%-8s %5u bytes  %8.1f MB/s  %3u allocations  %5u bytes allocated per build\n",
+           name, (unsigned)c.bytes, c.bytesPerSec / 1e6, (unsigned)c.allocs, (unsigned)c.allocated);
+  }
+}
+
+namespace Checks {
+  int json(int argc, char** argv) {
+    size_t rounds = 200000;
+    for (int i = 2; i < argc; i++) {
+      if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) rounds = strtoul(argv[++i], nullptr, 10);
+    }
+    fillInput();
+    JsonWriter w(jsonBuf, sizeof(jsonBuf));
+    Cost writer = measure(rounds, [&w]() { return buildWriter(w); });
+    Cost string = measure(rounds, []() { return buildString().length(); });
+    print("writer", writer);
+    print("string", string);
+
+    // الطريقتان تكتبان النص نفسه لهذه القيم، و JsonWriter لا يحجز شيئاً
+    bool same = buildString() == std::string(w.c_str(), w.length());
+    printf("output   %s\n", same ? "identical" : "DIFFERENT");
+    return (!same || writer.allocs || w.overflowed()) ? 1 : 0;
+  }
+}
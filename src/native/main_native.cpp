@@ -0,0 +1,284 @@
+// main_native.cpp - تشغيل التجارب على الحاسوب ومقارنة النتائج بالتوقعات
+//
+// pio run -e native، ثم .pio/build/native/program:
+//   program [-v] [-r DIR]                       سقوط وبندول ورمية وإمالة حتى الانزلاق تركيبية
+//                                               مقابل القيم النظرية (-r: تُحفظ جلساتها في DIR بصيغة Recorder)
+//   program replay [-v] [--tol R] [--expect F] FILE...
+//                                               إعادة جلسات مسجلة على الجهاز (GET /sessions?n=K)
+// التوقع الافتراضي لكل جلسة هو نتيجة الجهاز المخزنة في خاتمتها للمقياس الرئيسي
+// (v0، period، g، mu) بحد نسبي R (1%). ملف --expect يضيف أو يستبدل توقعات بأسطر:
+//   <اسم الملف> <المقياس> <القيمة> <الحد المطلق>      (# للتعليقات)
+// رمز الخروج 1 إن خرجت نتيجة عن حدها، فيصلح فحصاً سريعاً بعد تعديل أي عتبة.
+//   program codec [-n ROUNDS] [--dump FILE]     فحص TraceCodec (انظر checks.hpp)
+//   program json [-n ROUNDS]                    كلفة JsonWriter مقابل السلاسل
+#include <chrono>
+#include "checks.hpp"
+#include "native.hpp"
+#include "engine.hpp"
+#include "orientation.hpp"
+#include "recorder.hpp"
+#include "replay.hpp"
+
+namespace {
+  const uint16_t RATE_HZ = 500;
+  const uint32_t DT_US = 1000000UL / RATE_HZ;
+  const size_t MAX_SAMPLES = 30 * RATE_HZ;
+  Sample trace[MAX_SAMPLES];
+
+  // معاملات /start للتجربة الجارية
+  struct Param { const char* key; float value; };
+  const Param* params = nullptr;
+  size_t paramCount = 0;
+
+  float param(const char* key) {
+    for (size_t i = 0; i < paramCount; i++) if (strcmp(params[i].key, key) == 0) return params[i].value;
+    return 0.0f;
+  }
+
+  // ضجيج ثابت البذرة: الإعادة تعطي النتيجة نفسها في كل تشغيل
+  uint32_t seed = 12345;
+  float noise(float amplitude) {
+    seed = seed * 1664525u + 1013904223u;
+    return amplitude * ((float)(seed >> 8) / 8388608.0f - 1.0f);
+  }
+
+  Sample at(uint32_t t, float ax, float ay, float az) {
+    Sample s;
+    s.t_us = t;
+    s.ax = ax + noise(0.01f); s.ay = ay + noise(0.01f); s.az = az + noise(0.01f);
+    s.gx = noise(0.5f); s.gy = noise(0.5f); s.gz = noise(0.5f);
+    return s;
+  }
+
+  // الجهاز مسطح وساكن ثم يسقط d متراً ويرتطم
+  size_t dropTrace(float distance) {
+    size_t n = 0;
+    uint32_t t = 1000000;
+    float fallUs = sqrtf(2.0f * distance / GRAVITY_CONST) * 1e6f;
+    for (int i = 0; i < RATE_HZ; i++, t += DT_US) trace[n++] = at(t, 0, 0, 1.0f);
+    for (uint32_t u = 0; u < fallUs && n < MAX_SAMPLES; u += DT_US, t += DT_US) trace[n++] = at(t, 0, 0, 0.02f);
+    for (int i = 0; i < 10; i++, t += DT_US) trace[n++] = at(t, 0, 0, 6.0f);
+    for (int i = 0; i < RATE_HZ / 2; i++, t += DT_US) trace[n++] = at(t, 0, 0, 1.0f);
+    return n;
+  }
+
+  // بندول طوله L: المركبة Y جيبية بزمن دوري 2π√(L/g)
+  size_t swingTrace(float length, float amplitude) {
+    size_t n = 0;
+    uint32_t t = 1000000;
+    float period = 2.0f * PI * sqrtf(length / GRAVITY_CONST);
+    for (int i = 0; i < RATE_HZ / 2; i++, t += DT_US) trace[n++] = at(t, 0, 0, 1.0f);
+    for (float s = 0; s < 25.0f * period && n < MAX_SAMPLES; s += DT_US / 1e6f, t += DT_US) {
+      trace[n++] = at(t, 0, amplitude * sinf(2.0f * PI * s / period), 1.0f);
+    }
+    return n;
+  }
+
+  // رمية رأسية من جهاز مسطح: دفع 50 مللي ثانية يعطي السرعة v0، ثم تحليق حر حتى العودة
+  // لارتفاع الإطلاق، ثم التقاط يوقفه في 80 مللي ثانية (كل القيم ضمن مدى الحساس ±8 g)
+  size_t throwTrace(float v0) {
+    size_t n = 0;
+    uint32_t t = 1000000;
+    const int PUSH = 25, CATCH = 40;
+    float push = v0 / (GRAVITY_CONST * PUSH * DT_US / 1e6f);   // g
+    float flightUs = 2.0f * v0 / GRAVITY_CONST * 1e6f;
+    float stop = v0 / (GRAVITY_CONST * CATCH * DT_US / 1e6f);  // g
+    for (int i = 0; i < RATE_HZ; i++, t += DT_US) trace[n++] = at(t, 0, 0, 1.0f);
+    for (int i = 0; i < PUSH; i++, t += DT_US) trace[n++] = at(t, 0, 0, 1.0f + push);
+    for (uint32_t u = 0; u < flightUs && n < MAX_SAMPLES; u += DT_US, t += DT_US) trace[n++] = at(t, 0, 0, 0.0f);
+    for (int i = 0; i < CATCH; i++, t += DT_US) trace[n++] = at(t, 0, 0, 1.0f + stop);
+    for (int i = 0; i < RATE_HZ / 2; i++, t += DT_US) trace[n++] = at(t, 0, 0, 1.0f);
+    return n;
+  }
+
+  // إمالة منتظمة حول Y بسرعة 10 درجات/ث حتى slipDeg، ثم ينزلق الجهاز على المنحدر
+  // بتسارع 0.3 g (قراءة X تقترب من الصفر) بينما تستمر الإمالة
+  size_t tiltTrace(float slipDeg) {
+    size_t n = 0;
+    uint32_t t = 1000000;
+    const float RATE_DPS = 10.0f;
+    for (int i = 0; i < RATE_HZ / 2; i++, t += DT_US) trace[n++] = at(t, 0, 0, 1.0f);
+    float angle = 0, slidUs = 0;
+    while (slidUs < 300000.0f && n < MAX_SAMPLES) {
+      float rad = angle * (float)PI / 180.0f;
+      float slide = angle >= slipDeg ? 0.3f : 0.0f;
+      Sample s = at(t, -sinf(rad) + slide, 0, cosf(rad));
+      s.gy += RATE_DPS;
+      trace[n++] = s;
+      if (slide > 0) slidUs += DT_US;
+      angle += RATE_DPS * DT_US / 1e6f;
+      t += DT_US;
+    }
+    return n;
+  }
+
+  struct Check {
+    const char* key;
+    float expected;
+    float tolerance;
+  };
+
+  bool runCase(const char* name, const Param* p, size_t pn, size_t samples, const Check& check) {
+    params = p; paramCount = pn;
+    Engine::stop();
+    Orientation::reset();
+    Experiment* e = Engine::start(name, param);
+    if (!e) { printf("%-10s unknown experiment\n", name); return false; }
+
+    auto t0 = std::chrono::steady_clock::now();
+    Native::play(trace, samples);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+
+    Metric m[Engine::MAX_METRICS];
+    size_t n = e->metrics(m, Engine::MAX_METRICS);
+    float got = NAN;
+    for (size_t i = 0; i < n; i++) if (strcmp(m[i].key, check.key) == 0) got = m[i].value;
+    bool ok = experimentState == DONE && fabsf(got - check.expected) <= check.tolerance;
+    printf("%-10s %-17s %9.4f (expected %.4f ± %.4f)  %6.1f ns/sample  %s\n",
+           name, check.key, got, check.expected, check.tolerance, ns / samples, ok ? "ok" : "FAIL");
+    return ok;
+  }
+
+  // --------------------------------------------------------------
+  // إعادة الجلسات
+  // --------------------------------------------------------------
+  struct Expectation {
+    char file[64];
+    char key[20];
+    float value;
+    float tolerance;
+  };
+  const size_t MAX_EXPECTATIONS = 1024;
+  Expectation expectations[MAX_EXPECTATIONS];
+  size_t expectationCount = 0;
+
+  const char* baseName(const char* path) {
+    const char* slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+  }
+
+  bool loadExpectations(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    char line[160];
+    while (fgets(line, sizeof(line), f) && expectationCount < MAX_EXPECTATIONS) {
+      if (line[0] == '#') continue;
+      Expectation& x = expectations[expectationCount];
+      if (sscanf(line, "%63s %19s %f %f", x.file, x.key, &x.value, &x.tolerance) == 4) expectationCount++;
+    }
+    fclose(f);
+    return true;
+  }
+
+  float metric(const Metric* m, size_t n, const char* key) {
+    for (size_t i = 0; i < n; i++) if (strcmp(m[i].key, key) == 0) return m[i].value;
+    return NAN;
+  }
+
+  bool check(const char* file, const char* key, float got, float expected, float tolerance) {
+    bool ok = fabsf(got - expected) <= tolerance;
+    printf("%-20s %-10s %9.4f (expected %.4f ± %.4f)  %s\n", file, key, got, expected, tolerance, ok ? "ok" : "FAIL");
+    return ok;
+  }
+
+  // يرجع عدد التوقعات التي فشلت في هذه الجلسة
+  size_t replayFile(const char* path, float relTol, uint64_t& frames) {
+    const char* file = baseName(path);
+    Replay::Session s;
+    if (!Replay::load(path, s)) { printf("%-20s unreadable or not a session file  FAIL\n", file); return 1; }
+    uint32_t n = 0;
+    Experiment* e = Replay::play(s, &n);
+    frames += n;
+    if (!e) { printf("%-20s unknown experiment type %u  FAIL\n", file, s.header.type); Replay::release(s); return 1; }
+    if (n < s.footer.frames) printf("%-20s %u of %u frames decoded (damaged block)\n", file, (unsigned)n, (unsigned)s.footer.frames);
+
+    Metric m[Engine::MAX_METRICS];
+    size_t mn = e->metrics(m, Engine::MAX_METRICS);
+    bool done = experimentState == DONE;
+    size_t failed = 0, checked = 0;
+    for (size_t i = 0; i < expectationCount; i++) {
+      const Expectation& x = expectations[i];
+      if (strcmp(x.file, file) != 0) continue;
+      checked++;
+      if (!check(file, x.key, done ? metric(m, mn, x.key) : NAN, x.value, x.tolerance)) failed++;
+    }
+    if (!checked) {
+      const char* key = Replay::primaryKey(s.header.type);
+      float expected = NAN;
+      size_t rc = s.footer.resultCount < RunLog::MAX_RESULTS ? s.footer.resultCount : RunLog::MAX_RESULTS;
+      for (size_t i = 0; i < rc; i++) {
+        if (strncmp(s.footer.results[i].key, key, sizeof(s.footer.results[i].key)) == 0) expected = s.footer.results[i].value;
+      }
+      if (isnan(expected)) {
+        // أوقفت على الجهاز دون نتيجة: لا حكم، لكن يظهر إن صارت تُكشف الآن
+        printf("%-20s %-10s %9.4f (no result on device)\n", file, key, done ? metric(m, mn, key) : NAN);
+      } else {
+        float tolerance = fabsf(expected) * relTol;
+        if (!check(file, key, done ? metric(m, mn, key) : NAN, expected, tolerance > 1e-4f ? tolerance : 1e-4f)) failed++;
+      }
+    }
+    Replay::release(s);
+    return failed;
+  }
+
+  int replayMain(int argc, char** argv) {
+    float relTol = 0.01f;
+    size_t sessions = 0, failed = 0;
+    uint64_t frames = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 2; i < argc; i++) {
+      if (strcmp(argv[i], "-v") == 0) Native::verbose = true;
+      else if (strcmp(argv[i], "--tol") == 0 && i + 1 < argc) relTol = atof(argv[++i]);
+      else if (strcmp(argv[i], "--expect") == 0 && i + 1 < argc) {
+        if (!loadExpectations(argv[++i])) { printf("cannot read %s\n", argv[i]); return 2; }
+      } else {
+        failed += replayFile(argv[i], relTol, frames) ? 1 : 0;
+        sessions++;
+      }
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    printf("%u sessions, %u failed, %llu frames in %.1f ms (%.0f frames/s)\n", (unsigned)sessions, (unsigned)failed,
+           (unsigned long long)frames, ms, ms > 0 ? frames / ms * 1000.0 : 0.0);
+    return failed ? 1 : 0;
+  }
+}
+
+int main(int argc, char** argv) {
+  Sampler::begin(RATE_HZ);
+  Sound::begin();
+  if (argc > 1 && strcmp(argv[1], "replay") == 0) return replayMain(argc, argv);
+  if (argc > 1 && strcmp(argv[1], "codec") == 0) return Checks::codec(argc, argv);
+  if (argc > 1 && strcmp(argv[1], "json") == 0) return Checks::json(argc, argv);
+
+  float record = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-v") == 0) Native::verbose = true;
+    else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      if (!Recorder::begin(argv[++i])) { printf("cannot use %s\n", argv[i]); return 2; }
+      record = 1;
+    }
+  }
+  bool ok = true;
+
+  const Param drop[] = {{"distance", 1.0f}, {"trials", 1}, {"record", record}};
+  ok &= runCase("freefall", drop, 3, dropTrace(1.0f), {"g", GRAVITY_CONST, 0.2f});
+
+  const float length = 0.5f;
+  const Param swing[] = {{"length", length}, {"oscillations", 10}, {"trials", 1}, {"record", record}};
+  ok &= runCase("pendulum", swing, 4, swingTrace(length, 0.5f),
+                {"period", 2.0f * (float)PI * sqrtf(length / GRAVITY_CONST), 0.005f});
+
+  const float v0 = 2.0f;
+  const Param toss[] = {{"mass", 0.2f}, {"angle", 90}, {"trials", 1}, {"record", record}};
+  ok &= runCase("projectile", toss, 4, throwTrace(v0), {"v0", v0, 0.05f});
+  // بزاوية 45°: المسار الرأسي نفسه، فالسرعة v0/sin45 وأقصى ارتفاع نظري v0²/2g لا يتغير
+  const Param toss45[] = {{"mass", 0.2f}, {"angle", 45}, {"trials", 1}, {"record", record}};
+  ok &= runCase("projectile", toss45, 4, throwTrace(v0), {"v0", v0 * sqrtf(2.0f), 0.07f});
+  ok &= runCase("projectile", toss45, 4, throwTrace(v0), {"max_height_theory", v0 * v0 / (2.0f * GRAVITY_CONST), 0.01f});
+
+  const Param tilt[] = {{"trials", 1}, {"record", record}};
+  ok &= runCase("friction", tilt, 2, tiltTrace(25.0f), {"mu", tanf(25.0f * (float)PI / 180.0f), 0.02f});
+  ok &= runCase("friction", tilt, 2, tiltTrace(35.0f), {"mu", tanf(35.0f * (float)PI / 180.0f), 0.02f});
+
+  return ok ? 0 : 1;
+}
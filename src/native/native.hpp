@@ -0,0 +1,23 @@
+// native.hpp - ما يضيفه بناء الحاسوب فوق طبقة العتاد: حقن العينات وقراءة المخارج
+#pragma once
+
+#include "sampler.hpp"
+
+namespace Native {
+  // يطبع شاشات الحالة عند ظهورها (معطل افتراضياً حتى لا تغرق الإعادات الطويلة المخرجات)
+  extern bool verbose;
+
+  // يضع عينة في حلقة Sampler ويقدّم الساعة الافتراضية إلى ختمها.
+  // false إن كانت الحلقة ممتلئة (تُحسب في Sampler::dropped كما على الجهاز)
+  bool inject(const Sample& s);
+  size_t pending();
+
+  // يدفع العينات بالترتيب ويستدعي Engine::run و Sound::update كلما تجمعت دفعة،
+  // أي ما تفعله loop() على الجهاز لكن بأسرع ما يستطيع المعالج
+  void play(const Sample* samples, size_t n);
+
+  // مخارج الشاشة والسماعة
+  const char* lastStatus();
+  uint16_t currentTone();
+  uint32_t tones();
+}
@@ -0,0 +1,87 @@
+// replay.cpp - تحميل ملف الجلسة وتمريره إلى المحرك بأسرع ما يمكن
+#include "replay.hpp"
+#include "native.hpp"
+#include "orientation.hpp"
+#include "tap.hpp"
+
+namespace {
+  const Replay::Session* playing = nullptr;
+
+  float param(const char* key) {
+    const Recorder::Header& h = playing->header;
+    for (size_t i = 0; i < h.paramCount && i < RunLog::MAX_PARAMS; i++) {
+      if (strncmp(h.params[i].key, key, sizeof(h.params[i].key)) == 0) return h.params[i].value;
+    }
+    return 0.0f; // trials = 1 ولا تسجيل أثناء الإعادة
+  }
+}
+
+namespace Replay {
+  bool load(const char* path, Session& s) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    bool ok = size >= (long)(sizeof(Recorder::Header) + sizeof(Recorder::Footer)) &&
+              fread(&s.header, 1, sizeof(s.header), f) == sizeof(s.header);
+    if (ok) {
+      s.size = size - sizeof(Recorder::Header) - sizeof(Recorder::Footer);
+      s.blocks = (uint8_t*)malloc(s.size ? s.size : 1);
+      ok = s.blocks && fread(s.blocks, 1, s.size, f) == s.size &&
+           fread(&s.footer, 1, sizeof(s.footer), f) == sizeof(s.footer);
+    }
+    fclose(f);
+    ok = ok && memcmp(s.header.magic, "SES1", 4) == 0 && memcmp(s.footer.magic, "END1", 4) == 0;
+    if (!ok) release(s);
+    return ok;
+  }
+
+  void release(Session& s) {
+    free(s.blocks);
+    s.blocks = nullptr;
+    s.size = 0;
+  }
+
+  Experiment* play(const Session& s, uint32_t* frames) {
+    Experiment* e = nullptr;
+    for (size_t i = 0; i < Engine::count(); i++) {
+      if (Engine::at(i)->type() == s.header.type) e = Engine::at(i);
+    }
+    if (!e) return nullptr;
+
+    // حالة نظيفة لكل جلسة حتى لا تعتمد النتيجة على ترتيب الملفات
+    Engine::stop();
+    accelFilter.reset();
+    Orientation::reset();
+    Sampler::setRate(s.header.rateHz);
+    proj_g0 = s.header.rest[0]; pend_g0_y = s.header.rest[1];
+    fric_g0_x = s.header.rest[2]; fric_g0_z = s.header.rest[3];
+    playing = &s;
+    Engine::start(e->name(), param);
+
+    TraceCodec::Frame block[TraceCodec::BLOCK_FRAMES];
+    Sample samples[TraceCodec::BLOCK_FRAMES];
+    uint32_t total = 0;
+    size_t pos = 0, used = 0, n;
+    while (pos < s.size && (n = TraceCodec::decodeBlock(s.blocks + pos, s.size - pos, block, &used)) > 0) {
+      for (size_t i = 0; i < n; i++) Tap::toSample(block[i], samples[i]);
+      Native::play(samples, n);
+      total += n;
+      pos += used;
+    }
+    playing = nullptr;
+    if (frames) *frames = total;
+    return e;
+  }
+
+  const char* primaryKey(uint8_t type) {
+    switch (type) {
+      case PROJECTILE: return "v0";
+      case PENDULUM: return "period";
+      case FREEFALL: return "g";
+      case FRICTION: return "mu";
+      default: return "";
+    }
+  }
+}
@@ -0,0 +1,26 @@
+// replay.hpp - إعادة تشغيل جلسات Recorder على الحاسوب
+#pragma once
+
+#include "recorder.hpp"
+
+namespace Replay {
+  // الجلسة محمّلة كاملة في الذاكرة: الترويسة والخاتمة وكتل TraceCodec بينهما
+  struct Session {
+    Recorder::Header header;
+    Recorder::Footer footer;
+    uint8_t* blocks = nullptr;
+    size_t size = 0;
+  };
+
+  // false إن تعذرت القراءة أو لم تكن الصيغة SES1/END1
+  bool load(const char* path, Session& s);
+  void release(Session& s);
+
+  // يبدأ التجربة بمعاملات الجلسة وإزاحات السكون المسجلة ثم يدفع الإطارات
+  // كلها عبر Engine::run. يرجع التجربة (لقراءة metrics) أو nullptr إن كان
+  // نوعها غير مسجل. frames = عدد الإطارات المفكوكة (أقل من المسجل إن تلفت كتلة)
+  Experiment* play(const Session& s, uint32_t* frames);
+
+  // المقياس الذي تُحكم به كل تجربة: v0، period، g، mu
+  const char* primaryKey(uint8_t type);
+}
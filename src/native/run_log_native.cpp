@@ -0,0 +1,11 @@
+// run_log_native.cpp - سجل التشغيلات على الحاسوب: معطل (النتائج يقرؤها السائق من التجربة مباشرة)
+#include "run_log.hpp"
+
+namespace RunLog {
+  bool begin() { return false; }
+  bool ready() { return false; }
+  void append(const Experiment* e, size_t trial) { (void)e; (void)trial; }
+  uint32_t first() { return 0; }
+  uint32_t next() { return 0; }
+  bool read(uint32_t seq, Record& out) { (void)seq; (void)out; return false; }
+}
@@ -0,0 +1,36 @@
+// sampler_native.cpp - مصدر العينات على الحاسوب: حلقة يملؤها السائق بدل مهمة الحساس
+#include "sampler.hpp"
+#include "ring_buffer.hpp"
+#include "native.hpp"
+
+namespace {
+  // نفس سعة حلقة الجهاز، فالسائق يستدعي Engine::run قبل امتلائها كما تفعل loop()
+  SpscRing<Sample, 512> ring;
+  uint16_t rateHz = Sampler::DEFAULT_RATE_HZ;
+  uint32_t droppedCount = 0;
+}
+
+namespace Sampler {
+  void begin(uint16_t hz, Mode mode) { (void)mode; setRate(hz); }
+  void setRate(uint16_t hz) { if (hz > 0 && hz <= MAX_RATE_HZ) rateHz = hz; }
+  uint16_t rate() { return rateHz; }
+  Mode mode() { return Mode::HardwareFifo; }
+
+  bool pop(Sample& out) { return ring.pop(out); }
+  size_t popBatch(Sample* out, size_t max) { return ring.popBatch(out, max); }
+  size_t available() { return ring.size(); }
+  void discard() { ring.clear(); }
+  uint32_t dropped() { return droppedCount; }
+  float temperature() { return NAN; }
+}
+
+namespace Native {
+  bool inject(const Sample& s) {
+    Hal::setMicros(s.t_us);
+    if (ring.push(s)) return true;
+    droppedCount++;
+    return false;
+  }
+
+  size_t pending() { return ring.size(); }
+}
@@ -0,0 +1,51 @@
+// orientation.cpp - تنفيذ خدمة الاتجاه
+#include "orientation.hpp"
+#include "filters.hpp"
+#include "engine.hpp"
+
+namespace {
+  const float KP = 1.0f;   // ثابت زمني للتصحيح بالتسارع ≈ 1 ث
+  const float KI = 0.02f;  // يمتص ما تبقى من إزاحة الجيروسكوب بعد المعايرة
+  const float DEG = PI / 180.0f;
+
+  MahonyFilter filter(KP, KI);
+  bool aligned = false;
+  uint32_t lastT = 0;
+  Orientation::Pose poses[Engine::BATCH_SIZE];
+  Orientation::Pose latest = {0, 0, 0, 0, 0};
+}
+
+namespace Orientation {
+  void reset() { aligned = false; }
+
+  void update(const Sample* s, size_t n) {
+    if (n > Engine::BATCH_SIZE) n = Engine::BATCH_SIZE;
+    for (size_t i = 0; i < n; i++) {
+      float dt = (float)(int32_t)(s[i].t_us - lastT) / 1e6f;
+      // فجوة كبيرة (معايرة، إيقاف مؤقت) أو أول عينة: نحاذي من جديد بدل تكامل خاطئ
+      if (!aligned || dt <= 0 || dt > 0.1f) {
+        filter.align(s[i].ax, s[i].ay, s[i].az);
+        aligned = true;
+      } else {
+        filter.update(s[i].gx * DEG, s[i].gy * DEG, s[i].gz * DEG, s[i].ax, s[i].ay, s[i].az, dt);
+      }
+      lastT = s[i].t_us;
+
+      float ux, uy, uz;
+      filter.up(ux, uy, uz);
+      const float a[3] = {s[i].ax, s[i].ay, s[i].az};
+      float w[3];
+      filter.toWorld(a, w);
+      Pose& p = poses[i];
+      p.pitch = atan2f(-ux, uz) / DEG;
+      p.roll = atan2f(uy, uz) / DEG;
+      p.lx = w[0]; p.ly = w[1]; p.lz = w[2] - 1.0f;
+    }
+    if (n > 0) latest = poses[n - 1];
+  }
+
+  const Pose* batch() { return poses; }
+  float pitch() { return latest.pitch; }
+  float roll() { return latest.roll; }
+  void quaternion(float* q) { filter.quaternion(q); }
+}
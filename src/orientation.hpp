@@ -0,0 +1,25 @@
+// orientation.hpp - خدمة الاتجاه المشتركة: مرشح Mahony يتغذى من كل عينة (جيروسكوب + تسارع)
+#pragma once
+
+#include "hal.hpp"
+#include "sampler.hpp"
+
+namespace Orientation {
+  // ناتج كل عينة: زاويتا الميل والتسارع الخطي في الإطار الأرضي (Z للأعلى) بعد طرح الجاذبية
+  struct Pose {
+    float pitch, roll;  // درجات (الميل حول Y و X)
+    float lx, ly, lz;   // g
+  };
+
+  // يعيد ضبط الاتجاه من أول عينة قادمة (محاذاة مع الجاذبية، yaw = 0)
+  void reset();
+  // يُستدعى من Engine::run بكل دفعة بعد تطبيق المعايرة؛ زمن ثابت لكل عينة
+  void update(const Sample* samples, size_t n);
+  // النواتج لكل عينة من آخر دفعة مُررت إلى update (بنفس الترتيب)
+  const Pose* batch();
+
+  // أحدث قيم
+  float pitch();
+  float roll();
+  void quaternion(float* q);
+}
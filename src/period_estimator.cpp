@@ -0,0 +1,71 @@
+// period_estimator.cpp - ملاءمة خطية لأزمنة عبور الصفر
+#include <math.h>
+#include "period_estimator.hpp"
+
+void PeriodEstimator::reset() {
+    started = false;
+    t0_us = 0;
+    lastT = 0; lastV = 0;
+    armedSign = 0;
+    total = 0;
+    periodS = 0; periodErrS = 0;
+}
+
+bool PeriodEstimator::push(uint32_t t_us, float v) {
+    if (!started) {
+        started = true;
+        t0_us = t_us;
+        lastT = 0; lastV = v;
+        return false;
+    }
+    float t = (int32_t)(t_us - t0_us) / 1e6f;
+    bool crossed = false;
+
+    if (armedSign == 0) {
+        // ننتظر ابتعاد الإشارة عن الصفر لنعرف اتجاه العبور الأول
+        if (v > hyst) armedSign = -1;
+        else if (v < -hyst) armedSign = 1;
+    } else if ((armedSign > 0 && lastV < 0 && v >= 0) || (armedSign < 0 && lastV > 0 && v <= 0)) {
+        float tc = lastT + (t - lastT) * (lastV / (lastV - v));
+        // عبور أقرب من 40% من نصف الدور المقدّر = ضجيج وليس اهتزازة
+        bool spurious = hasEstimate() && total > 0 && (tc - crossT[(total - 1) % WINDOW]) < 0.2f * periodS;
+        if (!spurious) {
+            crossT[total % WINDOW] = tc;
+            total++;
+            crossed = true;
+            if (total >= 3) fit();
+        }
+        armedSign = 0; // لا نقبل عبوراً جديداً قبل تجاوز عتبة التخلف في الجهة الأخرى
+    }
+    lastT = t; lastV = v;
+    return crossed;
+}
+
+void PeriodEstimator::fit() {
+    size_t n = total < WINDOW ? total : WINDOW;
+    uint32_t first = total - n;
+    // x = رقم العبور (متمركز)، y = زمنه
+    float xm = (n - 1) / 2.0f, ym = 0;
+    for (size_t i = 0; i < n; i++) ym += crossT[(first + i) % WINDOW];
+    ym /= n;
+    float sxx = 0, sxy = 0;
+    for (size_t i = 0; i < n; i++) {
+        float dx = i - xm;
+        sxx += dx * dx;
+        sxy += dx * (crossT[(first + i) % WINDOW] - ym);
+    }
+    float slope = sxy / sxx;
+    float ssr = 0;
+    for (size_t i = 0; i < n; i++) {
+        float r = crossT[(first + i) % WINDOW] - (ym + slope * (i - xm));
+        ssr += r * r;
+    }
+    periodS = 2.0f * slope;
+    periodErrS = n > 2 ? 2.0f * sqrtf(ssr / (n - 2) / sxx) : periodS;
+}
+
+float PeriodEstimator::confidence() const {
+    if (!hasEstimate() || periodS <= 0) return 0;
+    float rel = periodErrS / periodS / 0.01f;
+    return 1.0f / (1.0f + rel * rel);
+}
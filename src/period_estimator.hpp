@@ -0,0 +1,41 @@
+// period_estimator.hpp - تقدير الزمن الدوري من أزمنة عبور الصفر المستوفاة
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// يكتشف عبور الإشارة للصفر (مع تخلف hysteresis لرفض الارتداد)، ويستوفي
+// زمن العبور خطياً بين العينتين المحيطتين به بدقة أقل من فاصل العينة.
+// ثم يوفّق خطاً بالمربعات الصغرى بين رقم العبور وزمنه على نافذة منزلقة:
+// الميل = نصف الزمن الدوري، وخطأ الميل المعياري يعطي عدم اليقين.
+class PeriodEstimator {
+public:
+    static constexpr size_t WINDOW = 32; // آخر 32 عبوراً = 16 اهتزازة
+
+    explicit PeriodEstimator(float hysteresis = 0.03f) : hyst(hysteresis) { reset(); }
+
+    void reset();
+    // يرجع true إذا سُجّل عبور جديد مع هذه العينة
+    bool push(uint32_t t_us, float value);
+
+    // عدد العبورات منذ reset (عبوران لكل اهتزازة كاملة)
+    uint32_t crossings() const { return total; }
+    bool hasEstimate() const { return total >= 3; }
+    float period() const { return periodS; }
+    // الانحراف المعياري لتقدير الزمن الدوري (ثانية)
+    float uncertainty() const { return periodErrS; }
+    // 1 = تقدير دقيق، 0.5 عند خطأ نسبي 1%، ويقترب من 0 كلما زاد الخطأ
+    float confidence() const;
+
+private:
+    float hyst;
+    bool started;
+    uint32_t t0_us;       // أصل الزمن (أول عينة) حتى تبقى الأزمنة float دقيقة
+    float lastT, lastV;
+    int8_t armedSign;     // الإشارة التي يجب أن نعبر إليها في العبور القادم
+    float crossT[WINDOW]; // أزمنة العبور بالثواني (حلقة دائرية)
+    uint32_t total;
+    float periodS, periodErrS;
+
+    void fit();
+};
@@ -0,0 +1,158 @@
+#pragma once
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "filters.hpp"
+
+// Compile-time filter chains, e.g.
+//   Pipeline<Kalman, Biquad<LowPass>, Median<5>> chain;
+//   float y; if (chain.push(x, y)) { ... }
+// Every stage exposes `bool push(float in, float& out)` (false = no output
+// for this input, used by Decimator) and `reset()`. The chain is a nested
+// template, so push() inlines to straight-line code with no virtual calls.
+// Runtime-tunable stages are reached with chain.stage<I>().
+
+// -----------------------------------------------------------------
+// Stages
+// -----------------------------------------------------------------
+
+// Scalar KalmanFilter as a pipeline stage.
+struct Kalman {
+    KalmanFilter f;
+    inline void setTuning(float q, float r) { f.setTuning(q, r); }
+    inline bool push(float in, float& out) { out = f.update(in); return true; }
+    inline void reset() { f.reset(); }
+};
+
+// Exponential moving average: y += alpha * (x - y).
+struct Ema {
+    float alpha = 0.4f;
+    float y = 0.0f;
+    inline void setAlpha(float a) { alpha = a; }
+    inline bool push(float in, float& out) { y += alpha * (in - y); out = y; return true; }
+    inline void reset(float initial = 0.0f) { y = initial; }
+};
+
+// Biquad response types (RBJ audio-EQ cookbook).
+struct LowPass {
+    static void coeffs(float cosw, float alpha, float* b, float* a) {
+        b[0] = (1 - cosw) / 2; b[1] = 1 - cosw; b[2] = (1 - cosw) / 2;
+        a[0] = 1 + alpha; a[1] = -2 * cosw; a[2] = 1 - alpha;
+    }
+};
+struct HighPass {
+    static void coeffs(float cosw, float alpha, float* b, float* a) {
+        b[0] = (1 + cosw) / 2; b[1] = -(1 + cosw); b[2] = (1 + cosw) / 2;
+        a[0] = 1 + alpha; a[1] = -2 * cosw; a[2] = 1 - alpha;
+    }
+};
+
+// Second-order IIR section, transposed direct form II.
+// Call setup() before use; until then it passes the input through.
+template <typename Type>
+struct Biquad {
+    float b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+    float z1 = 0, z2 = 0;
+
+    void setup(float cutoffHz, float sampleHz, float q = 0.7071f) {
+        float w = 2.0f * (float)M_PI * cutoffHz / sampleHz;
+        float alpha = sinf(w) / (2.0f * q);
+        float b[3], a[3];
+        Type::coeffs(cosf(w), alpha, b, a);
+        b0 = b[0] / a[0]; b1 = b[1] / a[0]; b2 = b[2] / a[0];
+        a1 = a[1] / a[0]; a2 = a[2] / a[0];
+        reset();
+    }
+    inline bool push(float in, float& out) {
+        out = b0 * in + z1;
+        z1 = b1 * in - a1 * out + z2;
+        z2 = b2 * in - a2 * out;
+        return true;
+    }
+    inline void reset() { z1 = z2 = 0; }
+};
+
+// Moving median over the last N inputs (N odd). Rejects single-sample spikes.
+template <size_t N>
+struct Median {
+    static_assert(N % 2 == 1, "Median window must be odd");
+    float window[N] = {};
+    size_t pos = 0, filled = 0;
+
+    inline bool push(float in, float& out) {
+        window[pos] = in;
+        pos = (pos + 1) % N;
+        if (filled < N) filled++;
+        float sorted[N];
+        for (size_t i = 0; i < filled; i++) {
+            float v = window[i];
+            size_t j = i;
+            while (j > 0 && sorted[j - 1] > v) { sorted[j] = sorted[j - 1]; j--; }
+            sorted[j] = v;
+        }
+        out = sorted[filled / 2];
+        return true;
+    }
+    inline void reset() { pos = 0; filled = 0; }
+};
+
+// Emits one output per N inputs (put a low-pass stage in front of it).
+template <size_t N>
+struct Decimator {
+    static_assert(N >= 1, "Decimation factor must be >= 1");
+    size_t count = 0;
+    inline bool push(float in, float& out) {
+        if (++count < N) return false;
+        count = 0;
+        out = in;
+        return true;
+    }
+    inline void reset() { count = 0; }
+};
+
+// -----------------------------------------------------------------
+// Pipeline
+// -----------------------------------------------------------------
+template <typename... Stages>
+class Pipeline;
+
+template <>
+class Pipeline<> {
+public:
+    inline bool push(float in, float& out) { out = in; return true; }
+    inline void reset() {}
+};
+
+namespace pipeline_detail {
+    template <size_t I>
+    struct StageGet {
+        template <typename P>
+        static auto get(P& p) -> decltype(StageGet<I - 1>::get(p.rest())) { return StageGet<I - 1>::get(p.rest()); }
+    };
+    template <>
+    struct StageGet<0> {
+        template <typename P>
+        static auto get(P& p) -> decltype(p.first()) { return p.first(); }
+    };
+}
+
+template <typename Head, typename... Tail>
+class Pipeline<Head, Tail...> {
+    Head head;
+    Pipeline<Tail...> tail;
+public:
+    inline bool push(float in, float& out) {
+        float mid;
+        if (!head.push(in, mid)) return false;
+        return tail.push(mid, out);
+    }
+    inline void reset() { head.reset(); tail.reset(); }
+
+    inline Head& first() { return head; }
+    inline Pipeline<Tail...>& rest() { return tail; }
+
+    template <size_t I>
+    inline auto stage() -> decltype(pipeline_detail::StageGet<I>::get(*this)) {
+        return pipeline_detail::StageGet<I>::get(*this);
+    }
+};
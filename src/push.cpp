@@ -0,0 +1,209 @@
+// push.cpp - تنفيذ قناة SSE بعملاء WiFiClient محتفظ بهم
+#include <WiFi.h>
+#include <lwip/sockets.h>
+#include <atomic>
+#include "push.hpp"
+#include "sampler.hpp"
+#include "tap.hpp"
+
+namespace {
+  enum class Kind : uint8_t { Free, Pending, Events, Stream };
+
+  struct Slot {
+    WiFiClient client;
+    Kind kind = Kind::Free;
+    uint32_t since = 0;
+    char line[48];     // سطر الطلب الأول فقط: "GET /events HTTP/1.1"
+    uint8_t len = 0;
+    uint16_t lineLen = 0; // طول السطر الجاري (0 عند سطر فارغ = نهاية الترويسات)
+    bool gotLine = false;
+    // البث: مؤشر القارئ في Tap وقسمة التخفيض الخاصة بهذا العميل
+    uint32_t cursor = 0;
+    uint16_t div = 1;
+  };
+
+  const uint32_t REQUEST_TIMEOUT_MS = 2000;
+  const size_t STREAM_BURST = 32; // إطارات لكل كتابة (512 بايت)
+  WiFiServer server(Push::PORT);
+  Slot slots[Push::MAX_EVENT_CLIENTS + Push::MAX_STREAM_CLIENTS];
+  uint32_t lastKeepalive = 0;
+
+  void drop(Slot& s) {
+    s.client.stop();
+    s.client = WiFiClient();
+    s.kind = Kind::Free;
+  }
+
+  size_t count(Kind kind) {
+    size_t n = 0;
+    for (auto& s : slots) if (s.kind == kind) n++;
+    return n;
+  }
+
+  // كتابة على المقبس دون انتظار: WiFiClient::write يعيد المحاولة مع عميل متوقف
+  // ثانية في كل مرة حتى 10 مرات، فيحجز مهمة HTTP كلها.
+  // يرجع البايتات المقبولة، و 0 إن كان مخزن الإرسال ممتلئاً، و -1 عند خطأ
+  int trySend(Slot& s, const char* data, size_t len) {
+    int r = send(s.client.fd(), data, len, MSG_DONTWAIT);
+    if (r >= 0) return r;
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  }
+
+  // الرسالة كاملة أو يُفصل العميل: الباقي من كتابة جزئية يقطع الحدث أو الإطار التالي
+  bool sendAll(Slot& s, const char* data, size_t len) {
+    if (trySend(s, data, len) == (int)len) return true;
+    drop(s);
+    return false;
+  }
+
+  // يرجع true عند اكتمال الترويسات (سطر فارغ بعد سطر الطلب)
+  bool readRequest(Slot& s) {
+    while (s.client.available()) {
+      int c = s.client.read();
+      if (c < 0) break;
+      if (c == '\r') continue;
+      if (c == '\n') {
+        if (s.lineLen == 0 && s.gotLine) return true;
+        if (s.lineLen > 0) s.gotLine = true;
+        s.lineLen = 0;
+        continue;
+      }
+      s.lineLen++;
+      // نحتفظ بالسطر الأول فقط، وما بعده من ترويسات يُقرأ ويُهمل
+      if (!s.gotLine && s.len < sizeof(s.line) - 1) s.line[s.len++] = (char)c;
+    }
+    return false;
+  }
+
+  // يرسل ما تراكم في Tap منذ آخر مرة، إطاراً كل div، على دفعات
+  void pump(Slot& s) {
+    const int32_t WINDOW = Tap::CAPACITY - Tap::GUARD;
+    Tap::Frame out[STREAM_BURST];
+    for (;;) {
+      // head يُقرأ من جديد لكل دفعة: الكاتب يتقدم أثناء الإرسال
+      uint32_t head = Tap::head();
+      // المؤشر قد يسبق head بأقل من div، لذا المقارنة بإشارة
+      if ((int32_t)(head - s.cursor) > WINDOW) s.cursor = head - WINDOW; // تأخر أكثر من الحلقة: نقفز إلى الأقدم المتاح
+      uint32_t next = s.cursor;
+      size_t n = 0;
+      while (n < STREAM_BURST && (int32_t)(head - next) > 0) {
+        out[n++] = Tap::at(next);
+        next += s.div;
+      }
+      if (!n) return;
+      // تحقق بعد النسخ كما في seqlock: إن اقترب الكاتب من أقدم إطار منسوخ فربما كُتب
+      // فوقه أثناء النسخ، فتُهمل الدفعة وتُعاد من الأقدم المتاح
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if ((int32_t)(Tap::head() - s.cursor) > WINDOW) continue;
+      size_t bytes = n * sizeof(Tap::Frame);
+      int sent = trySend(s, (const char*)out, bytes);
+      if (sent == 0) return; // مخزن الإرسال ممتلئ: الدفعة نفسها في الاستدعاء التالي
+      if (sent != (int)bytes) { drop(s); return; }
+      s.cursor = next;
+      if (n < STREAM_BURST) return;
+    }
+  }
+
+  void route(Slot& s) {
+    s.line[s.len] = 0;
+    bool events = strncmp(s.line, "GET /events", 11) == 0;
+    bool stream = strncmp(s.line, "GET /stream", 11) == 0;
+    if ((events && count(Kind::Events) >= Push::MAX_EVENT_CLIENTS) ||
+        (stream && count(Kind::Stream) >= Push::MAX_STREAM_CLIENTS)) {
+      static const char BUSY[] = "HTTP/1.1 503 Service Unavailable\r\nRetry-After: 5\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+      sendAll(s, BUSY, sizeof(BUSY) - 1);
+      drop(s);
+      return;
+    }
+    if (events) {
+      static const char HEAD[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Connection: keep-alive\r\n\r\n"
+        "retry: 2000\n\n";
+      if (sendAll(s, HEAD, sizeof(HEAD) - 1)) s.kind = Kind::Events;
+      return;
+    }
+    if (stream) {
+      const char* q = strstr(s.line, "hz=");
+      long hz = q ? atol(q + 3) : Push::STREAM_DEFAULT_HZ;
+      uint16_t rate = Sampler::rate();
+      if (hz < 1) hz = 1;
+      if (hz > rate) hz = rate;
+      s.div = (uint16_t)(rate / hz);
+      s.cursor = Tap::head();
+      static const char HEAD[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/octet-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Connection: close\r\n\r\n"
+        "IMU1";
+      uint16_t info[4] = {Tap::ACCEL_LSB_PER_G, Tap::GYRO_LSB_PER_DPS, (uint16_t)(rate / s.div), s.div};
+      if (sendAll(s, HEAD, sizeof(HEAD) - 1) && sendAll(s, (const char*)info, sizeof(info))) s.kind = Kind::Stream;
+      return;
+    }
+    static const char NOT_FOUND[] = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    sendAll(s, NOT_FOUND, sizeof(NOT_FOUND) - 1);
+    drop(s);
+  }
+}
+
+namespace Push {
+  void begin() {
+    server.begin();
+    server.setNoDelay(true);
+  }
+
+  bool poll() {
+    bool joined = false;
+    WiFiClient c = server.available();
+    if (c) {
+      Slot* free = nullptr;
+      for (auto& s : slots) if (s.kind == Kind::Free) { free = &s; break; }
+      if (free) {
+        free->client = c;
+        free->client.setNoDelay(true);
+        free->kind = Kind::Pending;
+        free->since = millis();
+        free->len = 0; free->lineLen = 0; free->gotLine = false;
+      } else {
+        c.stop(); // كل المقاعد مشغولة
+      }
+    }
+
+    uint32_t now = millis();
+    for (auto& s : slots) {
+      if (s.kind == Kind::Pending) {
+        if (readRequest(s)) { route(s); joined |= s.kind == Kind::Events; }
+        else if (!s.client.connected() || now - s.since > REQUEST_TIMEOUT_MS) drop(s);
+      } else if ((s.kind == Kind::Events || s.kind == Kind::Stream) && !s.client.connected()) {
+        drop(s);
+      } else if (s.kind == Kind::Stream) {
+        pump(s);
+      }
+    }
+
+    if (now - lastKeepalive >= KEEPALIVE_MS) {
+      lastKeepalive = now;
+      static const char PING[] = ": ping\n\n";
+      for (auto& s : slots) if (s.kind == Kind::Events) sendAll(s, PING, sizeof(PING) - 1);
+    }
+    return joined;
+  }
+
+  void event(const char* name, const char* data, size_t len) {
+    // الرسالة كاملة في مخزن ثابت حتى تخرج في كتابة واحدة لكل مشترك
+    static char msg[EVENT_MAX];
+    int head = snprintf(msg, sizeof(msg), "event: %s\ndata: ", name);
+    if (head < 0 || head + len + 2 > sizeof(msg)) return;
+    memcpy(msg + head, data, len);
+    memcpy(msg + head + len, "\n\n", 2);
+    size_t total = head + len + 2;
+    for (auto& s : slots) if (s.kind == Kind::Events) sendAll(s, msg, total);
+  }
+
+  size_t subscribers() { return count(Kind::Events); }
+}
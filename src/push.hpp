@@ -0,0 +1,35 @@
+// push.hpp - قنوات الدفع على منفذ مستقل: Server-Sent Events (بدل استطلاع /results)
+// وبث ثنائي حي للعينات (GET /stream)
+#pragma once
+
+#include <Arduino.h>
+
+namespace Push {
+  // منفذ مستقل حتى لا يحجز اتصال طويل العمر خادم الصفحات (WebServer ينتظر إغلاق العميل)
+  constexpr uint16_t PORT = 81;
+  // حد لكل نوع حتى لا يزاحم البث مشتركي الأحداث (كل صفحة تفتح الاثنين عادة).
+  // المجموع 12 مقبساً، ويبقى من CONFIG_LWIP_MAX_SOCKETS (16) ما يكفي لخادم الصفحات و DNS.
+  // الطلب الذي ينتظر قراءة ترويساته يشغل مقعداً فارغاً، والزائد عن حد نوعه يُرد بـ 503
+  constexpr size_t MAX_EVENT_CLIENTS = 6;
+  constexpr size_t MAX_STREAM_CLIENTS = 6;
+  constexpr uint32_t KEEPALIVE_MS = 15000;
+  // أقصى طول لرسالة حدث (الترويسة + البيانات)؛ الأطول لا يُرسل
+  constexpr size_t EVENT_MAX = 1280;
+
+  // GET /stream?hz=N: بث ثنائي (Tap::Frame) مخفض لكل عميل على حدة إلى ~N إطار/ث
+  //   (افتراضياً 50). الجسم بلا طول محدد ويبدأ بترويسة 12 بايت:
+  //   "IMU1", uint16 ACCEL_LSB_PER_G, uint16 GYRO_LSB_PER_DPS, uint16 معدل الإطارات, uint16 قسمة التخفيض
+  constexpr uint16_t STREAM_DEFAULT_HZ = 50;
+
+  void begin();
+  // يقبل الاتصالات الجديدة ويقرأ طلباتها دون حجز، ويضخ إطارات البث لكل عميل من مؤشره
+  // في Tap، ويرسل نبضة إبقاء الاتصال.
+  // يرجع true إن انضم مشترك جديد (ليُرسل له الوضع الحالي)
+  bool poll();
+  // يبث حدثاً لكل المشتركين في GET /events: "event: <name>\ndata: <data>\n\n".
+  // الكتابة دون انتظار (MSG_DONTWAIT)، فالعميل الذي لا يتسع مخزن إرساله للرسالة كاملة
+  // يُفصل فوراً بدل أن يحجز مهمة HTTP. عميل البث المتأخر تنتظره دفعته للاستدعاء التالي
+  // ولا يُفصل إلا بكتابة جزئية
+  void event(const char* name, const char* data, size_t len);
+  size_t subscribers();
+}
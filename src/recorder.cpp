@@ -0,0 +1,173 @@
+// recorder.cpp - كتابة الجلسات: ترويسة ثم كتل مرمزة ثم خاتمة بالنتائج
+#include "recorder.hpp"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "tap.hpp"
+
+namespace {
+  char dir[40] = "";
+  bool mounted = false;
+  FILE* file = nullptr;
+  // الجلسات المكتملة [firstN, nextN)؛ يكتبها loop() ويقرؤها خادم HTTP
+  volatile uint32_t firstN = 0, nextN = 0;
+
+  TraceCodec::Frame frames[TraceCodec::BLOCK_FRAMES];
+  size_t frameCount = 0;
+  uint8_t block[TraceCodec::MAX_BLOCK_BYTES];
+  uint32_t written = 0;
+  size_t bytes = 0;
+  bool truncated = false;
+
+  void sessionPath(char* out, size_t cap, uint32_t n) {
+    snprintf(out, cap, "%s/%u.ses", dir, (unsigned)n);
+  }
+
+  void removeSession(uint32_t n) {
+    char path[56];
+    sessionPath(path, sizeof(path), n);
+    remove(path);
+  }
+
+  // الكتلة الجارية إلى الملف؛ بعد MAX_BYTES تُهمل الكتل وتبقى الخاتمة
+  void flush() {
+    if (!frameCount) return;
+    size_t len = TraceCodec::encodeBlock(frames, frameCount, block);
+    if (bytes + len > Recorder::MAX_BYTES || fwrite(block, 1, len, file) != len) truncated = true;
+    else { bytes += len; written += frameCount; }
+    frameCount = 0;
+  }
+
+  // انقطاع الطاقة أثناء التسجيل يترك آخر ملف دون Footer فترفضه الإعادة. تُعدّ الكتل
+  // السليمة بعد الترويسة، ويُقص ما بعدها (كتلة نصف مكتوبة)، ثم تُلحق خاتمة دون نتائج
+  // بـ truncated. يرجع false إن حُذف الملف لأنه غير قابل للإصلاح
+  bool recover(uint32_t n) {
+    char path[56];
+    sessionPath(path, sizeof(path), n);
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+
+    Recorder::Footer tail;
+    if (size >= (long)(sizeof(Recorder::Header) + sizeof(tail)) &&
+        fseek(f, size - sizeof(tail), SEEK_SET) == 0 &&
+        fread(&tail, 1, sizeof(tail), f) == sizeof(tail) && memcmp(tail.magic, "END1", 4) == 0) {
+      fclose(f);
+      return true;
+    }
+
+    Recorder::Header h;
+    fseek(f, 0, SEEK_SET);
+    bool ok = fread(&h, 1, sizeof(h), f) == sizeof(h) && memcmp(h.magic, "SES1", 4) == 0;
+    long pos = sizeof(h);
+    uint32_t count = 0;
+    while (ok && pos < size && fseek(f, pos, SEEK_SET) == 0) {
+      size_t avail = fread(block, 1, sizeof(block), f), used = 0;
+      size_t k = TraceCodec::decodeBlock(block, avail, frames, &used);
+      if (!k) break;
+      count += k;
+      pos += used;
+    }
+    fclose(f);
+    ok = ok && (pos == size || truncate(path, pos) == 0);
+
+    Recorder::Footer foot;
+    memset(&foot, 0, sizeof(foot));
+    memcpy(foot.magic, "END1", 4);
+    foot.frames = count;
+    foot.truncated = 1;
+    f = ok ? fopen(path, "ab") : nullptr;
+    ok = f && fwrite(&foot, 1, sizeof(foot), f) == sizeof(foot);
+    if (f) ok = fclose(f) == 0 && ok;
+    if (!ok) remove(path);
+    return ok;
+  }
+}
+
+namespace Recorder {
+  bool begin(const char* path) {
+    if (mounted) return true;
+    snprintf(dir, sizeof(dir), "%s", path);
+    mkdir(dir, 0755);
+    DIR* d = opendir(dir);
+    if (!d) return false;
+
+    // الفهرس من أسماء الملفات كما في RunLog
+    bool any = false;
+    uint32_t lo = 0, hi = 0;
+    for (struct dirent* ent = readdir(d); ent; ent = readdir(d)) {
+      char* end;
+      uint32_t n = strtoul(ent->d_name, &end, 10);
+      if (end == ent->d_name || strcmp(end, ".ses") != 0) continue;
+      if (!any || n < lo) lo = n;
+      if (!any || n > hi) hi = n;
+      any = true;
+    }
+    closedir(d);
+    // الجلسات السابقة أُغلقت قبل فتح التالية، فلا يُحتمل أن ينقص Footer إلا في الأعلى
+    if (any) { firstN = lo; nextN = recover(hi) ? hi + 1 : hi; }
+    mounted = true;
+    return true;
+  }
+
+  bool ready() { return mounted; }
+  bool active() { return file != nullptr; }
+  uint32_t first() { return firstN; }
+  uint32_t next() { return nextN; }
+
+  void start(const Experiment* e) {
+    if (!mounted || !e) return;
+    if (file) finish(nullptr);
+    while (nextN - firstN >= MAX_SESSIONS) removeSession(firstN++);
+
+    char path[56];
+    sessionPath(path, sizeof(path), nextN);
+    file = fopen(path, "wb");
+    if (!file) return;
+
+    Header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "SES1", 4);
+    h.rateHz = Sampler::rate();
+    h.type = (uint8_t)e->type();
+    h.runSeq = RunLog::next();
+    Metric m[Engine::MAX_METRICS];
+    size_t n = e->params(m, RunLog::MAX_PARAMS);
+    RunLog::copyFields(h.params, m, n);
+    h.paramCount = n;
+    h.rest[0] = proj_g0; h.rest[1] = pend_g0_y; h.rest[2] = fric_g0_x; h.rest[3] = fric_g0_z;
+    frameCount = 0; written = 0; truncated = false;
+    bytes = fwrite(&h, 1, sizeof(h), file);
+    if (bytes != sizeof(h)) { fclose(file); file = nullptr; remove(path); }
+  }
+
+  void feed(const Sample* samples, size_t n) {
+    if (!file) return;
+    for (size_t i = 0; i < n; i++) {
+      Tap::toFrame(samples[i], frames[frameCount++]);
+      if (frameCount == TraceCodec::BLOCK_FRAMES) flush();
+    }
+  }
+
+  void finish(const Experiment* e) {
+    if (!file) return;
+    flush();
+    Footer f;
+    memset(&f, 0, sizeof(f));
+    memcpy(f.magic, "END1", 4);
+    f.frames = written;
+    f.truncated = truncated;
+    if (e) {
+      Metric m[Engine::MAX_METRICS];
+      size_t n = e->metrics(m, RunLog::MAX_RESULTS);
+      RunLog::copyFields(f.results, m, n);
+      f.resultCount = n;
+    }
+    bool ok = fwrite(&f, 1, sizeof(f), file) == sizeof(f);
+    ok = fclose(file) == 0 && ok;
+    file = nullptr;
+    if (ok) nextN = nextN + 1;
+    else removeSession(nextN);
+  }
+}
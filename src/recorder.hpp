@@ -0,0 +1,53 @@
+// recorder.hpp - تسجيل عينات الجلسة كاملة في ملف لإعادة تشغيلها على الحاسوب (src/native/replay)
+#pragma once
+
+#include "hal.hpp"
+#include "engine.hpp"
+#include "run_log.hpp"
+
+// الجلسة = محاولة واحدة من التسليح حتى DONE أو الإيقاف. الملف <dir>/<n>.ses:
+//   Header ثم كتل TraceCodec (إطارات Tap بعد المعايرة وقبل أي فلتر) ثم Footer
+//   بنتائج الجهاز، وهي التوقعات الافتراضية عند الإعادة.
+// الكتابة بـ stdio: على الجهاز عبر VFS لـ LittleFS (/littlefs/...) وعلى الحاسوب أي مجلد.
+// التسجيل اختياري لكل بدء (/start?...&record=1) حتى لا يُستهلك الفلاش دون حاجة.
+namespace Recorder {
+  constexpr size_t MAX_SESSIONS = 8;
+  // ~60 ث عند 500Hz بضغط ~4.4 بايت/إطار (program codec)؛ ما بعده لا يُكتب (truncated في Footer)
+  constexpr size_t MAX_BYTES = 128 * 1024;
+
+  struct __attribute__((packed)) Header {
+    char magic[4];          // "SES1"
+    uint16_t rateHz;
+    uint8_t type;           // ExperimentType
+    uint8_t paramCount;
+    uint32_t runSeq;        // رقم التشغيل المقابل في /runs إن انتهت الجلسة بنتيجة
+    RunLog::Field params[RunLog::MAX_PARAMS];
+    float rest[4];          // proj_g0, pend_g0_y, fric_g0_x, fric_g0_z وقت التسليح
+    uint8_t reserved[8];
+  };
+
+  struct __attribute__((packed)) Footer {
+    char magic[4];          // "END1"
+    uint32_t frames;        // الإطارات المكتوبة فعلاً
+    uint8_t resultCount;    // 0: أوقفت الجلسة قبل النتيجة (تبقى مفيدة لحالات عدم الكشف)
+    uint8_t truncated;
+    uint8_t reserved[2];
+    RunLog::Field results[RunLog::MAX_RESULTS];
+  };
+
+  // dir موجود أو يُنشأ؛ يُحسب رقم الجلسة التالية من أسماء الملفات الموجودة، وتُغلق
+  // آخر جلسة قطعها انقطاع الطاقة بخاتمة truncated (أو تُحذف إن لم تصلح)
+  bool begin(const char* dir);
+  bool ready();
+
+  // من Engine: التسليح يفتح ملفاً جديداً (ويحذف الأقدم فوق MAX_SESSIONS)،
+  // وكل دفعة معايَرة تُلحق، والنهاية تكتب Footer بنتائج التجربة (أو دونها)
+  void start(const Experiment* e);
+  void feed(const Sample* samples, size_t n);
+  void finish(const Experiment* e);
+  bool active();
+
+  // الجلسات المكتملة هي [first(), next())، وقد يكون بعضها محذوفاً
+  uint32_t first();
+  uint32_t next();
+}
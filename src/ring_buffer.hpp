@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Lock-free single-producer / single-consumer ring buffer.
+// The producer only writes `head`, the consumer only writes `tail`, so no
+// lock is needed as long as each side stays on its own task/core.
+// N must be a power of two (one slot is kept free to tell full from empty).
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+private:
+    T buf[N];
+    std::atomic<uint32_t> head{0}; // next slot to write (producer)
+    std::atomic<uint32_t> tail{0}; // next slot to read (consumer)
+public:
+    static constexpr size_t capacity() { return N - 1; }
+
+    // Producer side: returns false (and drops the item) when the ring is full.
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t next = (h + 1) & (N - 1);
+        if (next == tail.load(std::memory_order_acquire)) return false;
+        buf[h] = item;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side.
+    bool pop(T& out) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        out = buf[t];
+        tail.store((t + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: copies up to `max` items, returns how many were read.
+    size_t popBatch(T* out, size_t max) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        size_t n = 0;
+        while (t != h && n < max) {
+            out[n++] = buf[t];
+            t = (t + 1) & (N - 1);
+        }
+        tail.store(t, std::memory_order_release);
+        return n;
+    }
+
+    size_t size() const {
+        uint32_t h = head.load(std::memory_order_acquire);
+        uint32_t t = tail.load(std::memory_order_acquire);
+        return (h - t) & (N - 1);
+    }
+
+    // Consumer side: drop everything currently queued.
+    void clear() { tail.store(head.load(std::memory_order_acquire), std::memory_order_release); }
+};
@@ -0,0 +1,120 @@
+// run_log.cpp - تنفيذ سجل التشغيلات: مقاطع إضافة فقط + فهرس في الذاكرة
+#include "run_log.hpp"
+#include <LittleFS.h>
+#include <time.h>
+#include "esp32/rom/crc.h"
+#include "capture.hpp"
+
+namespace {
+  const char* DIR = "/runs";
+  bool mounted = false;
+  // الفهرس: يكفي أول وآخر رقم لأن السجلات متتالية وبحجم ثابت.
+  // يكتبه loop() ويقرؤه خادم HTTP
+  volatile uint32_t firstSeq = 0, nextSeq = 0;
+
+  void segmentPath(char* out, size_t cap, uint32_t segment) {
+    snprintf(out, cap, "%s/%u.bin", DIR, (unsigned)segment);
+  }
+
+  uint32_t crcOf(const RunLog::Record& r) {
+    return crc32_le(0, (const uint8_t*)&r, offsetof(RunLog::Record, crc));
+  }
+
+  void removeSegment(uint32_t segment) {
+    char path[24];
+    segmentPath(path, sizeof(path), segment);
+    LittleFS.remove(path);
+  }
+}
+
+namespace RunLog {
+  bool begin() {
+    if (mounted) return true;
+    // true: يهيئ القسم إن لم يكن LittleFS (أول إقلاع)
+    if (!LittleFS.begin(true)) return false;
+    if (!LittleFS.exists(DIR)) LittleFS.mkdir(DIR);
+
+    // بناء الفهرس من أسماء المقاطع: أصغر رقم وأكبر رقم وطول آخر مقطع
+    File dir = LittleFS.open(DIR);
+    bool any = false;
+    uint32_t lo = 0, hi = 0;
+    size_t hiSize = 0;
+    for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+      const char* name = strrchr(f.name(), '/');
+      name = name ? name + 1 : f.name();
+      char* end;
+      uint32_t segment = strtoul(name, &end, 10);
+      if (end == name || strcmp(end, ".bin") != 0) continue;
+      if (!any || segment < lo) lo = segment;
+      if (!any || segment > hi) { hi = segment; hiSize = f.size(); }
+      any = true;
+    }
+    if (any) {
+      // مقاطع تجاوزت حد الاحتفاظ (مثلاً بعد تصغير MAX_SEGMENTS)
+      while (hi - lo >= MAX_SEGMENTS) removeSegment(lo++);
+      firstSeq = lo * SEGMENT_RECORDS;
+      nextSeq = hi * SEGMENT_RECORDS + hiSize / sizeof(Record);
+    }
+    mounted = true;
+    return true;
+  }
+
+  bool ready() { return mounted; }
+  uint32_t first() { return firstSeq; }
+  uint32_t next() { return nextSeq; }
+
+  void append(const Experiment* e, size_t trial) {
+    if (!mounted || !e) return;
+    Record r;
+    memset(&r, 0, sizeof(r));
+    r.seq = nextSeq;
+    time_t now = time(nullptr);
+    r.unixTime = now > 1600000000 ? (uint32_t)now : 0;
+    r.uptimeMs = millis();
+    r.capture = Capture::generation();
+    r.type = (uint8_t)e->type();
+    r.trial = trial > 255 ? 255 : (uint8_t)trial;
+
+    Metric m[Engine::MAX_METRICS];
+    size_t n = e->params(m, MAX_PARAMS);
+    copyFields(r.params, m, n);
+    r.paramCount = n;
+    n = e->metrics(m, MAX_RESULTS);
+    copyFields(r.results, m, n);
+    r.resultCount = n;
+    r.crc = crcOf(r);
+
+    uint32_t segment = r.seq / SEGMENT_RECORDS;
+    size_t offset = (r.seq % SEGMENT_RECORDS) * sizeof(Record);
+    char path[24];
+    segmentPath(path, sizeof(path), segment);
+    // مقطع جديد يُنشأ؛ وإلا نكتب في موضع السجل (لا بعد ذيل قد يكون ناقصاً)
+    File f = LittleFS.open(path, offset ? "r+" : "w");
+    if (!f) return;
+    bool ok = f.seek(offset) && f.write((const uint8_t*)&r, sizeof(r)) == sizeof(r);
+    f.close();
+    if (!ok) return;
+    nextSeq = r.seq + 1;
+
+    // التدوير: بدء مقطع جديد فوق الحد يحذف أقدمها
+    if (offset == 0 && segment >= MAX_SEGMENTS) {
+      uint32_t oldest = segment - MAX_SEGMENTS;
+      if (firstSeq <= oldest * SEGMENT_RECORDS) {
+        firstSeq = (oldest + 1) * SEGMENT_RECORDS;
+        removeSegment(oldest);
+      }
+    }
+  }
+
+  bool read(uint32_t seq, Record& out) {
+    if (!mounted || seq < firstSeq || seq >= nextSeq) return false;
+    char path[24];
+    segmentPath(path, sizeof(path), seq / SEGMENT_RECORDS);
+    File f = LittleFS.open(path, "r");
+    if (!f) return false;
+    bool ok = f.seek((seq % SEGMENT_RECORDS) * sizeof(Record)) &&
+              f.read((uint8_t*)&out, sizeof(out)) == sizeof(out);
+    f.close();
+    return ok && out.seq == seq && out.crc == crcOf(out);
+  }
+}
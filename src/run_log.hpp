@@ -0,0 +1,64 @@
+// run_log.hpp - سجل دائم للتشغيلات المنتهية على LittleFS (يبقى بعد إعادة الضبط وإعادة التشغيل)
+#pragma once
+
+#include "hal.hpp"
+#include "engine.hpp"
+
+namespace RunLog {
+  // السجل مقسم إلى ملفات (مقاطع) بأسماء أرقامها: /runs/<k>.bin يحمل التشغيلات
+  // ذات الأرقام [k*SEGMENT_RECORDS, (k+1)*SEGMENT_RECORDS). السجلات بحجم ثابت،
+  // فمكان التشغيل رقم seq يُحسب مباشرة دون بحث.
+  // عند امتلاء MAX_SEGMENTS يُحذف أقدم مقطع كاملاً: حجم السجل على الفلاش ثابت
+  // (≈ 320 KB) والكتابة إضافة فقط، وتوزيع المسح على الكتل تتولاه LittleFS
+  constexpr size_t SEGMENT_RECORDS = 128;
+  constexpr size_t MAX_SEGMENTS = 8;
+  constexpr size_t MAX_PARAMS = 2;
+  constexpr size_t MAX_RESULTS = Engine::MAX_METRICS;
+
+  struct __attribute__((packed)) Field {
+    char key[20];           // منتهٍ بصفر (المفاتيح الأطول تُقص)
+    float value;
+    uint8_t decimals;
+    uint8_t reserved[3];
+  };
+
+  struct __attribute__((packed)) Record {
+    uint32_t seq;           // رقم التشغيل منذ أول تهيئة للسجل (لا يُعاد استعماله)
+    uint32_t unixTime;      // 0 إن لم يُضبط الوقت من الشبكة بعد
+    uint32_t uptimeMs;
+    uint32_t capture;       // Capture::generation() عند الانتهاء: هل ما زال /export لهذا التشغيل
+    uint8_t type;           // ExperimentType
+    uint8_t paramCount;
+    uint8_t resultCount;
+    uint8_t trial;          // رقم المحاولة في وضع المحاولات المتعددة (1 للمحاولة المفردة)
+    Field params[MAX_PARAMS];
+    Field results[MAX_RESULTS];
+    uint8_t reserved[16];
+    uint32_t crc;           // CRC32 لكل ما سبق
+  };
+  static_assert(sizeof(Record) == 320, "RunLog::Record size is part of the on-flash format");
+
+  // ينسخ المقاييس إلى حقول السجل (تُستعمل أيضاً في ملفات Recorder)
+  inline void copyFields(Field* out, const Metric* m, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      memset(&out[i], 0, sizeof(out[i]));
+      strncpy(out[i].key, m[i].key, sizeof(out[i].key) - 1);
+      out[i].value = m[i].value;
+      out[i].decimals = m[i].decimals;
+    }
+  }
+
+  // يركّب LittleFS (ويهيئه عند أول استعمال) ويبني الفهرس من أسماء المقاطع.
+  // يرجع false إن تعذر التركيب؛ يبقى السجل معطلاً دون أن يوقف البرنامج
+  bool begin();
+  bool ready();
+
+  // يضيف نتيجة التجربة المنتهية (من loop عبر Engine)
+  void append(const Experiment* e, size_t trial);
+
+  // التشغيلات المحفوظة هي [first(), next())
+  uint32_t first();
+  uint32_t next();
+  // يقرأ التشغيل رقم seq ويتحقق من CRC
+  bool read(uint32_t seq, Record& out);
+}
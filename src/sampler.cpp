@@ -0,0 +1,184 @@
+// sampler.cpp - قراءة IMU في مهمة FreeRTOS مستقلة عن loop()
+#include <M5Unified.h>
+#include "sampler.hpp"
+#include "ring_buffer.hpp"
+
+namespace {
+  // 512 عينة = ~1 ثانية عند 500Hz، تكفي لامتصاص أي توقف مؤقت في loop()
+  SpscRing<Sample, 512> ring;
+  TaskHandle_t task = nullptr;
+  volatile uint16_t rateHz = Sampler::DEFAULT_RATE_HZ;
+  volatile uint32_t droppedCount = 0;
+  volatile float lastTempC = NAN;
+  volatile bool rateChanged = false; // يطبّقه fifoTask حتى يبقى ناقل I2C حكراً على مهمة واحدة
+  Sampler::Mode activeMode = Sampler::Mode::Polling;
+
+  const BaseType_t SAMPLER_CORE = 0;
+  const UBaseType_t SAMPLER_PRIORITY = 5; // أعلى من مهام Arduino وأدنى من WiFi
+
+  TickType_t periodTicks() {
+    TickType_t t = pdMS_TO_TICKS(1000 / rateHz);
+    return t > 0 ? t : 1;
+  }
+
+  // ------------------------------------------------------------------
+  // MPU6886 (المستشعر المدمج في StickC PLUS2) - وصول مباشر لسجلات FIFO
+  // ------------------------------------------------------------------
+  namespace mpu {
+    const uint8_t ADDR = 0x68;
+    const uint32_t I2C_FREQ = 400000;
+    const uint8_t REG_SMPLRT_DIV = 0x19;
+    const uint8_t REG_GYRO_CONFIG = 0x1B;
+    const uint8_t REG_ACCEL_CONFIG = 0x1C;
+    const uint8_t REG_FIFO_EN = 0x23;
+    const uint8_t REG_INT_STATUS = 0x3A;
+    const uint8_t REG_USER_CTRL = 0x6A;
+    const uint8_t REG_FIFO_COUNT_H = 0x72;
+    const uint8_t REG_FIFO_R_W = 0x74;
+    const uint8_t REG_WHO_AM_I = 0x75;
+    const uint8_t WHO_AM_I_MPU6886 = 0x19;
+    const float TEMP_LSB_PER_C = 326.8f;        // T = raw / 326.8 + 25
+
+    const uint8_t FIFO_EN_ACCEL_GYRO = 0x18;   // GYRO_FIFO_EN | ACCEL_FIFO_EN
+    const uint8_t USER_CTRL_FIFO_EN = 0x40;
+    const uint8_t USER_CTRL_FIFO_RST = 0x04;
+    const uint8_t INT_STATUS_FIFO_OFLOW = 0x10;
+    const size_t PACKET_BYTES = 14;             // accel(6) + temp(2) + gyro(6)
+    const size_t FIFO_BYTES = 1024;
+    const size_t BURST_PACKETS = 32;            // عدد الحزم في معاملة I2C واحدة
+
+    float accelLsbPerG = 4096.0f;
+    float gyroLsbPerDps = 16.4f;
+
+    bool write(uint8_t reg, uint8_t v) { return M5.In_I2C.writeRegister8(ADDR, reg, v, I2C_FREQ); }
+    uint8_t read8(uint8_t reg) { return M5.In_I2C.readRegister8(ADDR, reg, I2C_FREQ); }
+    bool read(uint8_t reg, uint8_t* buf, size_t len) { return M5.In_I2C.readRegister(ADDR, reg, buf, len, I2C_FREQ); }
+    int16_t be16(const uint8_t* p) { return (int16_t)((p[0] << 8) | p[1]); }
+
+    void resetFifo() {
+      write(REG_USER_CTRL, USER_CTRL_FIFO_RST);
+      write(REG_USER_CTRL, USER_CTRL_FIFO_EN);
+    }
+
+    bool beginFifo(uint16_t hz) {
+      if (read8(REG_WHO_AM_I) != WHO_AM_I_MPU6886) return false;
+      // مقياس التسارع كما ضبطته M5Unified (AFS_SEL في البتات 4:3)
+      uint8_t afs = (read8(REG_ACCEL_CONFIG) >> 3) & 0x03;
+      accelLsbPerG = 16384.0f / (float)(1 << afs);
+      // وكذلك مقياس الجيروسكوب (FS_SEL في البتات 4:3)
+      uint8_t fs = (read8(REG_GYRO_CONFIG) >> 3) & 0x03;
+      gyroLsbPerDps = 131.0f / (float)(1 << fs);
+      // ODR = 1kHz / (1 + SMPLRT_DIV) مع تفعيل DLPF (الإعداد الافتراضي لـ M5Unified)
+      write(REG_SMPLRT_DIV, (uint8_t)(1000 / hz - 1));
+      write(REG_FIFO_EN, FIFO_EN_ACCEL_GYRO);
+      resetFifo();
+      return true;
+    }
+
+    // يقرأ كل الحزم الكاملة المتوفرة ويدفعها للحلقة بأختام زمنية متساوية الفواصل
+    void drainFifo(uint32_t periodUs, uint32_t& nextT) {
+      if (read8(REG_INT_STATUS) & INT_STATUS_FIFO_OFLOW) {
+        // فُقدت عينات داخل الحساس: نبدأ من جديد بدلاً من خلط فواصل غير متساوية
+        resetFifo();
+        nextT = 0;
+        return;
+      }
+      uint8_t cnt[2];
+      if (!read(REG_FIFO_COUNT_H, cnt, 2)) return;
+      size_t packets = (((cnt[0] & 0x1F) << 8) | cnt[1]) / PACKET_BYTES;
+      if (packets == 0) return;
+
+      // آخر حزمة في FIFO قيست الآن تقريباً؛ نعيد المزامنة إن انحرف العداد التركيبي
+      uint32_t now = micros();
+      uint32_t firstT = now - (uint32_t)(packets - 1) * periodUs;
+      if (nextT == 0 || (int32_t)(firstT - nextT) > (int32_t)(2 * periodUs) || (int32_t)(nextT - firstT) > (int32_t)(2 * periodUs)) {
+        nextT = firstT;
+      }
+
+      uint8_t buf[BURST_PACKETS * PACKET_BYTES];
+      while (packets > 0) {
+        size_t n = packets < BURST_PACKETS ? packets : BURST_PACKETS;
+        if (!read(REG_FIFO_R_W, buf, n * PACKET_BYTES)) { resetFifo(); nextT = 0; return; }
+        for (size_t i = 0; i < n; i++) {
+          const uint8_t* p = buf + i * PACKET_BYTES;
+          Sample s;
+          s.t_us = nextT;
+          s.ax = be16(p + 0) / accelLsbPerG;
+          s.ay = be16(p + 2) / accelLsbPerG;
+          s.az = be16(p + 4) / accelLsbPerG;
+          s.gx = be16(p + 8) / gyroLsbPerDps;
+          s.gy = be16(p + 10) / gyroLsbPerDps;
+          s.gz = be16(p + 12) / gyroLsbPerDps;
+          nextT += periodUs;
+          if (!ring.push(s)) droppedCount++;
+        }
+        lastTempC = be16(buf + (n - 1) * PACKET_BYTES + 6) / TEMP_LSB_PER_C + 25.0f;
+        packets -= n;
+      }
+    }
+  }
+
+  void pollingTask(void*) {
+    TickType_t lastWake = xTaskGetTickCount();
+    uint32_t n = 0;
+    for (;;) {
+      Sample s;
+      M5.Imu.getAccelData(&s.ax, &s.ay, &s.az);
+      M5.Imu.getGyroData(&s.gx, &s.gy, &s.gz);
+      s.t_us = micros();
+      if (!ring.push(s)) droppedCount++;
+      if ((n++ % 256) == 0) { float t; if (M5.Imu.getTemp(&t)) lastTempC = t; }
+      vTaskDelayUntil(&lastWake, periodTicks());
+    }
+  }
+
+  void fifoTask(void*) {
+    // نفرغ كل 10ms تقريباً: 5-10 عينات لكل دفعة، وبعيداً عن امتلاء FIFO (73 حزمة)
+    const TickType_t DRAIN_TICKS = pdMS_TO_TICKS(10);
+    TickType_t lastWake = xTaskGetTickCount();
+    uint32_t nextT = 0;
+    for (;;) {
+      if (rateChanged) {
+        rateChanged = false;
+        mpu::write(mpu::REG_SMPLRT_DIV, (uint8_t)(1000 / rateHz - 1));
+        mpu::resetFifo();
+        nextT = 0;
+      }
+      mpu::drainFifo(1000000UL / rateHz, nextT);
+      vTaskDelayUntil(&lastWake, DRAIN_TICKS > 0 ? DRAIN_TICKS : 1);
+    }
+  }
+}
+
+namespace Sampler {
+  void begin(uint16_t hz, Mode mode) {
+    setRate(hz);
+    if (task) return;
+    if (mode == Mode::HardwareFifo && mpu::beginFifo(rateHz)) {
+      activeMode = Mode::HardwareFifo;
+      xTaskCreatePinnedToCore(fifoTask, "imu_sampler", 4096, nullptr, SAMPLER_PRIORITY, &task, SAMPLER_CORE);
+    } else {
+      activeMode = Mode::Polling;
+      xTaskCreatePinnedToCore(pollingTask, "imu_sampler", 4096, nullptr, SAMPLER_PRIORITY, &task, SAMPLER_CORE);
+    }
+    Serial.printf("Sampler: %u Hz, mode=%s\n", rate(), activeMode == Mode::HardwareFifo ? "fifo" : "polling");
+  }
+
+  void setRate(uint16_t hz) {
+    if (hz == 0) hz = DEFAULT_RATE_HZ;
+    if (hz > MAX_RATE_HZ) hz = MAX_RATE_HZ;
+    // نقرب إلى أقرب معدل من الشكل 1000/n (يناسب كلاً من نبضة FreeRTOS و SMPLRT_DIV)
+    rateHz = 1000 / (1000 / hz);
+    if (task && activeMode == Mode::HardwareFifo) rateChanged = true;
+  }
+
+  uint16_t rate() { return rateHz; }
+  Mode mode() { return activeMode; }
+
+  bool pop(Sample& out) { return ring.pop(out); }
+  size_t popBatch(Sample* out, size_t max) { return ring.popBatch(out, max); }
+  size_t available() { return ring.size(); }
+  void discard() { ring.clear(); }
+  uint32_t dropped() { return droppedCount; }
+  float temperature() { return lastTempC; }
+}
@@ -0,0 +1,42 @@
+// sampler.hpp - مهمة أخذ عينات IMU بمعدل ثابت على النواة الأخرى
+#pragma once
+
+#include "hal.hpp"
+
+// عينة واحدة من الحساس مع ختم زمني بالميكروثانية (micros())
+struct Sample {
+    uint32_t t_us;
+    float ax, ay, az; // بوحدة g
+    float gx, gy, gz; // بوحدة درجة/ث
+};
+
+namespace Sampler {
+  // المعدل الافتراضي (Hz). المؤقت يعتمد على نبضة FreeRTOS (1 kHz) لذا
+  // المعدلات الفعلية هي 1000/n: 1000، 500، 333، 250 ...
+  constexpr uint16_t DEFAULT_RATE_HZ = 500;
+  constexpr uint16_t MAX_RATE_HZ = 1000;
+
+  // Polling: قراءة سجلات الحساس عينةً بعينة (معاملة I2C لكل عينة)
+  // HardwareFifo: الحساس يملأ FIFO الداخلي بمعدل ODR مضبوط في العتاد
+  //               والمهمة تفرغه على دفعات (أقل معاملات وعينات متساوية الفواصل)
+  enum class Mode { Polling, HardwareFifo };
+
+  // يبدأ مهمة القراءة مثبّتة على النواة 0 (حلقة Arduino تعمل على النواة 1).
+  // إن لم يُعثر على MPU6886 يرجع تلقائياً إلى وضع Polling.
+  void begin(uint16_t rateHz = DEFAULT_RATE_HZ, Mode mode = Mode::HardwareFifo);
+  void setRate(uint16_t rateHz);
+  uint16_t rate();
+  Mode mode();
+
+  // جهة المستهلك (loop): سحب العينات بالترتيب
+  bool pop(Sample& out);
+  size_t popBatch(Sample* out, size_t max);
+  size_t available();
+  void discard();
+
+  // عدد العينات التي أُسقطت لامتلاء الحلقة (المستهلك متأخر)
+  uint32_t dropped();
+
+  // آخر حرارة قرأتها المهمة من الحساس (°C)، أو NAN قبل أول قراءة
+  float temperature();
+}
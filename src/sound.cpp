@@ -18,6 +18,9 @@ namespace {
   const SeqStep calibrateDoneSteps[] = {
     {1400,120,40},{1700,160,0}
   };
+  const SeqStep calibratePositionSteps[] = {
+    {1600,80,0}
+  };
   const SeqStep expProjectileStart[] = {
     {1200,100,40},{1500,100,40},{1800,140,0}
   };
@@ -67,21 +70,20 @@ namespace {
   }
 
   void stopTone() {
-    if (current.active && millis() >= current.endMs) {
-      M5.Speaker.stop();
+    if (current.active && Hal::millis() >= current.endMs) {
+      Hal::toneStop();
       current.active = false;
     }
   }
 
   void processSequence() {
     if (!seq.active) return;
-    unsigned long now = millis();
+    unsigned long now = Hal::millis();
     if (current.active) return; // wait tone end first
     if (now < seq.nextStart) return; // wait gap
     if (seq.index >= seq.count) { seq.active = false; return; }
     const auto& step = seq.steps[seq.index];
-    M5.Speaker.setVolume(255);
-    M5.Speaker.tone(step.freq);
+    Hal::tone(step.freq);
     current.freq = step.freq;
     current.endMs = now + step.dur;
     current.active = true;
@@ -95,6 +97,7 @@ namespace {
       case Sound::Event::Startup: return {startupSteps, sizeof(startupSteps)/sizeof(SeqStep)};
       case Sound::Event::CalibrateStart: return {calibrateStartSteps, sizeof(calibrateStartSteps)/sizeof(SeqStep)};
       case Sound::Event::CalibrateDone: return {calibrateDoneSteps, sizeof(calibrateDoneSteps)/sizeof(SeqStep)};
+      case Sound::Event::CalibratePosition: return {calibratePositionSteps, sizeof(calibratePositionSteps)/sizeof(SeqStep)};
       case Sound::Event::ExperimentStartProjectile: return {expProjectileStart, sizeof(expProjectileStart)/sizeof(SeqStep)};
       case Sound::Event::ExperimentStartPendulum: return {expPendulumStart, sizeof(expPendulumStart)/sizeof(SeqStep)};
   case Sound::Event::PendulumMeasureStart: return {pendulumMeasureStartSeq, sizeof(pendulumMeasureStartSeq)/sizeof(SeqStep)};
@@ -124,10 +127,9 @@ namespace Sound {
 
   void playTone(int freq, int durationMs) {
     if (freq <= 0 || durationMs <= 0) return;
-    M5.Speaker.setVolume(255);
-    M5.Speaker.tone(freq);
+    Hal::tone(freq);
     current.freq = freq;
-    current.endMs = millis() + (unsigned long)durationMs;
+    current.endMs = Hal::millis() + (unsigned long)durationMs;
     current.active = true;
   }
 
@@ -1,11 +1,12 @@
 #pragma once
-#include <M5Unified.h>
+#include "hal.hpp"
 
 namespace Sound {
   enum class Event {
     Startup,
     CalibrateStart,
     CalibrateDone,
+    CalibratePosition,
     ExperimentStartProjectile,
     ExperimentStartPendulum,
     ExperimentStartFreefall,
@@ -0,0 +1,43 @@
+#pragma once
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Welford's online mean/variance. Numerically stable for long runs and needs
+// no sample storage, so repeated trials can be summarised as they arrive.
+class RunningStats {
+private:
+    uint32_t n;
+    float m;
+    float m2;   // sum of squared deviations from the running mean
+
+public:
+    RunningStats() { reset(); }
+
+    inline void reset() { n = 0; m = 0.0f; m2 = 0.0f; }
+
+    inline void push(float x) {
+        n++;
+        float d = x - m;
+        m += d / n;
+        m2 += d * (x - m);
+    }
+
+    inline uint32_t count() const { return n; }
+    inline float mean() const { return m; }
+    // Sample variance (n - 1); zero until there are two values.
+    inline float variance() const { return n > 1 ? m2 / (n - 1) : 0.0f; }
+    inline float stddev() const { return sqrtf(variance()); }
+
+    // Half-width of the two-sided 95% confidence interval of the mean,
+    // using Student's t for small n (class trials are usually 3-10).
+    float ci95() const {
+        if (n < 2) return 0.0f;
+        static const float T95[] = {12.706f, 4.303f, 3.182f, 2.776f, 2.571f, 2.447f, 2.365f, 2.306f, 2.262f, 2.228f,
+                                    2.201f, 2.179f, 2.160f, 2.145f, 2.131f, 2.120f, 2.110f, 2.101f, 2.093f, 2.086f,
+                                    2.080f, 2.074f, 2.069f, 2.064f, 2.060f, 2.056f, 2.052f, 2.048f, 2.045f, 2.042f};
+        uint32_t df = n - 1;
+        float t = df <= 30 ? T95[df - 1] : 1.960f;
+        return t * stddev() / sqrtf((float)n);
+    }
+};
@@ -0,0 +1,42 @@
+// tap.cpp - تنفيذ حلقة البث
+#include "tap.hpp"
+#include <atomic>
+
+namespace {
+  static_assert((Tap::CAPACITY & (Tap::CAPACITY - 1)) == 0, "Tap::CAPACITY must be a power of two");
+  Tap::Frame ring[Tap::CAPACITY];
+  std::atomic<uint32_t> written(0); // الكاتب على loop() والقارئ في مهمة HTTP
+
+  int16_t pack(float v, float scale) {
+    float x = v * scale;
+    if (x > 32767.0f) return 32767;
+    if (x < -32768.0f) return -32768;
+    return (int16_t)lrintf(x);
+  }
+}
+
+namespace Tap {
+  void toFrame(const Sample& s, Frame& f) {
+    f.t_us = s.t_us;
+    f.a[0] = pack(s.ax, ACCEL_LSB_PER_G); f.a[1] = pack(s.ay, ACCEL_LSB_PER_G); f.a[2] = pack(s.az, ACCEL_LSB_PER_G);
+    f.g[0] = pack(s.gx, GYRO_LSB_PER_DPS); f.g[1] = pack(s.gy, GYRO_LSB_PER_DPS); f.g[2] = pack(s.gz, GYRO_LSB_PER_DPS);
+  }
+
+  void toSample(const Frame& f, Sample& s) {
+    s.t_us = f.t_us;
+    s.ax = f.a[0] / (float)ACCEL_LSB_PER_G; s.ay = f.a[1] / (float)ACCEL_LSB_PER_G; s.az = f.a[2] / (float)ACCEL_LSB_PER_G;
+    s.gx = f.g[0] / (float)GYRO_LSB_PER_DPS; s.gy = f.g[1] / (float)GYRO_LSB_PER_DPS; s.gz = f.g[2] / (float)GYRO_LSB_PER_DPS;
+  }
+
+  void write(const Sample* s, size_t n) {
+    uint32_t w = written.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n; i++) {
+      toFrame(s[i], ring[w & (CAPACITY - 1)]);
+      // نشر الإطار بعد اكتماله: من يرى head الجديد يرى محتواه
+      written.store(++w, std::memory_order_release);
+    }
+  }
+
+  uint32_t head() { return written.load(std::memory_order_acquire); }
+  const Frame& at(uint32_t index) { return ring[index & (CAPACITY - 1)]; }
+}
@@ -0,0 +1,30 @@
+// tap.hpp - حلقة متعددة القراء للعينات المعايَرة بصيغة مضغوطة (للبث الحي للمتصفح)
+#pragma once
+
+#include "hal.hpp"
+#include "sampler.hpp"
+#include "trace_codec.hpp"
+
+namespace Tap {
+  // إطار 16 بايت little-endian كما يُرسل على السلك: ختم زمني + int16 لكل محور
+  // (a: g * ACCEL_LSB_PER_G بمدى ±8 g، g: درجة/ث * GYRO_LSB_PER_DPS بمدى ±2048 درجة/ث).
+  // هو نفسه إطار TraceCodec، فما يُبث يُضغط ويُخزن دون تحويل
+  typedef TraceCodec::Frame Frame;
+
+  constexpr uint16_t ACCEL_LSB_PER_G = 4096;
+  constexpr uint16_t GYRO_LSB_PER_DPS = 16;
+  // ~2 ث عند 500Hz: القارئ المتأخر أكثر من ذلك يقفز إلى الأقدم المتاح
+  constexpr uint32_t CAPACITY = 1024;
+  // القراء على نواة أخرى: لا نقرأ آخر GUARD خانة قبل موضع الكتابة التالي كي لا يُكتب فوق إطار أثناء نسخه
+  constexpr uint32_t GUARD = 128;
+
+  // التكميم وعكسه (دقة التسارع 1/4096 g تساوي دقة الحساس عند ±8 g)
+  void toFrame(const Sample& s, Frame& f);
+  void toSample(const Frame& f, Sample& s);
+
+  // كاتب واحد (Engine::run)؛ كل قارئ يحتفظ بمؤشره الخاص ولا يؤثر على غيره
+  void write(const Sample* samples, size_t n);
+  // عدد الإطارات المكتوبة منذ الإقلاع (يلتف عند 2^32)
+  uint32_t head();
+  const Frame& at(uint32_t index);
+}
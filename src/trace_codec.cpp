@@ -0,0 +1,166 @@
+// trace_codec.cpp - ترميز الكتل وفكها
+#include <string.h>
+#include "trace_codec.hpp"
+
+namespace {
+  using TraceCodec::BlockHeader;
+  using TraceCodec::Frame;
+  using TraceCodec::CHANNELS;
+
+  inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+  inline int32_t unzigzag(uint32_t u) { return (int32_t)(u >> 1) ^ -(int32_t)(u & 1); }
+
+  inline uint8_t bitWidth(uint32_t v) {
+    uint8_t w = 0;
+    while (v) { w++; v >>= 1; }
+    return w;
+  }
+
+  // المحاور الستة بالترتيب: a[0..2] ثم g[0..2]
+  inline void unpack(const Frame& f, int32_t v[CHANNELS]) {
+    v[0] = f.a[0]; v[1] = f.a[1]; v[2] = f.a[2];
+    v[3] = f.g[0]; v[4] = f.g[1]; v[5] = f.g[2];
+  }
+  inline void pack(Frame& f, const int32_t v[CHANNELS]) {
+    f.a[0] = (int16_t)v[0]; f.a[1] = (int16_t)v[1]; f.a[2] = (int16_t)v[2];
+    f.g[0] = (int16_t)v[3]; f.g[1] = (int16_t)v[4]; f.g[2] = (int16_t)v[5];
+  }
+
+  // البقايا المرمزة للإطار i (i ≥ 1): الزمن ثم المحاور
+  inline void residuals(const Frame* in, size_t i, uint16_t dtBase, uint32_t r[1 + CHANNELS]) {
+    int32_t cur[CHANNELS], prev[CHANNELS];
+    unpack(in[i], cur);
+    unpack(in[i - 1], prev);
+    r[0] = zigzag((int32_t)(in[i].t_us - in[i - 1].t_us - dtBase));
+    for (size_t c = 0; c < CHANNELS; c++) r[1 + c] = zigzag(cur[c] - prev[c]);
+  }
+
+  // تعبئة البتات من الأقل أهمية أولاً
+  struct BitWriter {
+    uint8_t* out;
+    size_t bytes = 0;
+    uint64_t acc = 0;
+    uint8_t bits = 0;
+
+    explicit BitWriter(uint8_t* o) : out(o) {}
+    inline void put(uint32_t v, uint8_t w) {
+      if (!w) return;
+      acc |= (uint64_t)v << bits;
+      bits += w;
+      while (bits >= 8) { out[bytes++] = (uint8_t)acc; acc >>= 8; bits -= 8; }
+    }
+    inline size_t finish() {
+      if (bits) { out[bytes++] = (uint8_t)acc; acc = 0; bits = 0; }
+      return bytes;
+    }
+  };
+
+  struct BitReader {
+    const uint8_t* in;
+    size_t pos = 0;
+    uint64_t acc = 0;
+    uint8_t bits = 0;
+
+    explicit BitReader(const uint8_t* i) : in(i) {}
+    inline uint32_t get(uint8_t w) {
+      if (!w) return 0;
+      while (bits < w) { acc |= (uint64_t)in[pos++] << bits; bits += 8; }
+      uint32_t v = (uint32_t)(acc & ((w == 32) ? 0xFFFFFFFFull : ((1ull << w) - 1)));
+      acc >>= w;
+      bits -= w;
+      return v;
+    }
+  };
+
+  uint8_t crc8(const uint8_t* p, size_t n, uint8_t crc = 0) {
+    while (n--) {
+      crc ^= *p++;
+      for (int b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+  }
+
+  // CRC الكتلة كما تُحسب عند الترميز: الترويسة بحقل crc صفر ثم الحمولة
+  uint8_t blockCrc(BlockHeader h, const uint8_t* payload) {
+    h.crc = 0;
+    return crc8(payload, h.payloadBytes, crc8((const uint8_t*)&h, sizeof(h)));
+  }
+
+  size_t payloadBits(const BlockHeader& h) {
+    size_t perFrame = 0;
+    for (size_t k = 0; k <= CHANNELS; k++) perFrame += h.widths[k];
+    return perFrame * (h.count - 1);
+  }
+}
+
+namespace TraceCodec {
+  size_t encodeBlock(const Frame* in, size_t n, uint8_t* out) {
+    if (n == 0) return 0;
+    if (n > BLOCK_FRAMES) n = BLOCK_FRAMES;
+
+    BlockHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = MAGIC;
+    h.count = (uint8_t)n;
+    h.t0 = in[0].t_us;
+    uint32_t dt = n > 1 ? in[1].t_us - in[0].t_us : 0;
+    h.dtBase = dt > 0xFFFF ? 0xFFFF : (uint16_t)dt;
+    int32_t first[CHANNELS];
+    unpack(in[0], first);
+    for (size_t c = 0; c < CHANNELS; c++) h.first[c] = (int16_t)first[c];
+
+    // المرور الأول: أوسع بقية في كل قناة يحدد عرضها
+    uint32_t widest[1 + CHANNELS] = {0};
+    uint32_t r[1 + CHANNELS];
+    for (size_t i = 1; i < n; i++) {
+      residuals(in, i, h.dtBase, r);
+      for (size_t k = 0; k <= CHANNELS; k++) widest[k] |= r[k];
+    }
+    for (size_t k = 0; k <= CHANNELS; k++) h.widths[k] = bitWidth(widest[k]);
+
+    // المرور الثاني: التعبئة
+    BitWriter w(out + sizeof(BlockHeader));
+    for (size_t i = 1; i < n; i++) {
+      residuals(in, i, h.dtBase, r);
+      for (size_t k = 0; k <= CHANNELS; k++) w.put(r[k], h.widths[k]);
+    }
+    h.payloadBytes = (uint16_t)w.finish();
+    h.crc = blockCrc(h, out + sizeof(BlockHeader));
+    memcpy(out, &h, sizeof(h));
+    return sizeof(h) + h.payloadBytes;
+  }
+
+  size_t peek(const uint8_t* in, size_t avail, BlockHeader* header) {
+    if (avail < sizeof(BlockHeader)) return 0;
+    BlockHeader h;
+    memcpy(&h, in, sizeof(h));
+    if (h.magic != MAGIC || h.count == 0 || h.count > BLOCK_FRAMES) return 0;
+    if (h.widths[0] > 32) return 0;
+    for (size_t c = 1; c <= CHANNELS; c++) if (h.widths[c] > 17) return 0;
+    if (h.payloadBytes != (payloadBits(h) + 7) / 8) return 0;
+    size_t total = sizeof(h) + h.payloadBytes;
+    if (avail < total) return 0;
+    if (header) *header = h;
+    return total;
+  }
+
+  size_t decodeBlock(const uint8_t* in, size_t avail, Frame* out, size_t* used) {
+    BlockHeader h;
+    size_t total = peek(in, avail, &h);
+    if (!total || blockCrc(h, in + sizeof(BlockHeader)) != h.crc) return 0;
+
+    int32_t v[CHANNELS];
+    for (size_t c = 0; c < CHANNELS; c++) v[c] = h.first[c];
+    out[0].t_us = h.t0;
+    pack(out[0], v);
+    BitReader r(in + sizeof(BlockHeader));
+    for (size_t i = 1; i < h.count; i++) {
+      out[i].t_us = out[i - 1].t_us + h.dtBase + (uint32_t)unzigzag(r.get(h.widths[0]));
+      // الفرق حُسب بدقة int32 بين قيمتين int16، فالناتج يعود ضمن int16 تماماً
+      for (size_t c = 0; c < CHANNELS; c++) v[c] = (int16_t)(v[c] + unzigzag(r.get(h.widths[1 + c])));
+      pack(out[i], v);
+    }
+    if (used) *used = total;
+    return h.count;
+  }
+}
@@ -0,0 +1,56 @@
+// trace_codec.hpp - ضغط مسارات IMU: تكميم int16 + فروق + zigzag + تعبئة بتات على كتل مستقلة
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// الصيغة مشتركة بين الجهاز (التسجيل والبث) والحاسوب (فك الترميز والإعادة)،
+// لذا لا يعتمد هذا الملف على Arduino.
+//
+// كل كتلة تحمل حتى BLOCK_FRAMES إطاراً وتُفك وحدها دون ما قبلها:
+//   BlockHeader ثم حمولة البتات. الإطار الأول مخزن كاملاً في الترويسة، ولكل
+//   إطار بعده: فرق الفاصل الزمني عن dtBase ثم فرق كل محور عن الإطار السابق،
+//   بترميز zigzag وعرض بتات ثابت لكل قناة في الكتلة (0 بت لقناة ثابتة).
+// طول الكتلة في ترويستها، فالتنقل بين الكتل (والبحث بالزمن عبر t0) لا يفك الحمولة.
+// CRC-8 (كثير الحدود 0x07) على الترويسة والحمولة يكشف الكتلة التالفة عند فكها.
+namespace TraceCodec {
+  // إطار مكمّم بدقة الحساس: 4096 LSB/g (±8 g) و 16 LSB/(درجة/ث) (±2000)
+  struct __attribute__((packed)) Frame {
+    uint32_t t_us;
+    int16_t a[3];
+    int16_t g[3];
+  };
+  static_assert(sizeof(Frame) == 16, "TraceCodec::Frame must stay 16 bytes");
+
+  constexpr size_t CHANNELS = 6;
+  constexpr size_t BLOCK_FRAMES = 64;
+  constexpr uint8_t MAGIC = 0xB7;
+
+  struct __attribute__((packed)) BlockHeader {
+    uint8_t magic;
+    uint8_t count;          // 1..BLOCK_FRAMES
+    uint16_t payloadBytes;
+    uint32_t t0;            // ختم الإطار الأول
+    uint16_t dtBase;        // الفاصل الزمني المرجعي (µs) داخل الكتلة
+    int16_t first[CHANNELS];
+    uint8_t widths[1 + CHANNELS]; // عرض البتات: الزمن ثم المحاور
+    uint8_t crc;            // على الكتلة كلها وهذا الحقل صفر
+  };
+  static_assert(sizeof(BlockHeader) == 30, "TraceCodec::BlockHeader is part of the stored format");
+
+  // أسوأ حالة: 32 بت للزمن و 17 بتاً لكل محور لكل إطار بعد الأول
+  constexpr size_t MAX_PAYLOAD = ((BLOCK_FRAMES - 1) * (32 + 17 * CHANNELS) + 7) / 8;
+  constexpr size_t MAX_BLOCK_BYTES = sizeof(BlockHeader) + MAX_PAYLOAD;
+
+  // يرمّز أول min(n, BLOCK_FRAMES) إطاراً في out (بسعة MAX_BLOCK_BYTES على الأقل).
+  // يرجع عدد البايتات المكتوبة، و 0 إن كان n == 0
+  size_t encodeBlock(const Frame* in, size_t n, uint8_t* out);
+
+  // يقرأ ترويسة الكتلة ويتحقق من اتساقها دون فك الحمولة (ودون CRC). يرجع طول الكتلة كاملة أو 0
+  size_t peek(const uint8_t* in, size_t avail, BlockHeader* header);
+
+  // يفك كتلة واحدة إلى out (بسعة BLOCK_FRAMES). يرجع عدد الإطارات، أو 0 إن كانت
+  // الكتلة ناقصة أو تالفة (ترويسة غير متسقة أو CRC مختلف)؛ used (اختياري) = طول
+  // الكتلة لمتابعة القراءة بعدها
+  size_t decodeBlock(const uint8_t* in, size_t avail, Frame* out, size_t* used = nullptr);
+}
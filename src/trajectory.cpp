@@ -0,0 +1,105 @@
+// trajectory.cpp - تكامل شبه منحرف/سيمبسون مع قيود السرعة الصفرية والهبوط
+#include <math.h>
+#include "trajectory.hpp"
+
+void Trajectory::reset() {
+    n = 0;
+    preCount = 0; preHead = 0;
+    iFreefall = 0; iRest = 0; iLand = 0;
+    built = false;
+}
+
+void Trajectory::pushPre(uint32_t t_us, float acc) {
+    preT[preHead] = t_us;
+    preA[preHead] = acc;
+    preHead = (preHead + 1) % PRE_TRIGGER;
+    if (preCount < PRE_TRIGGER) preCount++;
+}
+
+void Trajectory::beginThrow() {
+    n = 0;
+    size_t start = (preHead + PRE_TRIGGER - preCount) % PRE_TRIGGER;
+    for (size_t k = 0; k < preCount; k++) {
+        size_t j = (start + k) % PRE_TRIGGER;
+        t[n] = preT[j]; a[n] = preA[j]; n++;
+    }
+    preCount = 0;
+}
+
+bool Trajectory::push(uint32_t t_us, float acc) {
+    if (n >= CAPACITY) return false;
+    t[n] = t_us; a[n] = acc; n++;
+    return true;
+}
+
+void Trajectory::markFreefall() { iFreefall = n > 0 ? n - 1 : 0; }
+void Trajectory::markRest(size_t restSamples) { iRest = n > restSamples ? n - restSamples : 0; }
+
+Trajectory::Result Trajectory::reconstruct(float gravity) {
+    Result r = {false, 0, 0, 0, 0, 0};
+    built = false;
+    if (n < 4 || iFreefall == 0 || iRest <= iFreefall || iRest >= n) return r;
+
+    // نهاية التحليق (الاصطدام/الالتقاط)
+    iLand = iRest;
+    for (size_t i = iFreefall + 1; i < iRest; i++) {
+        if (a[i] > FLIGHT_END_G * gravity) { iLand = i; break; }
+    }
+
+    // أكبر تسارع أثناء الدفع، ومتوسط |a| أثناء التحليق
+    for (size_t i = 0; i < iFreefall; i++) if (fabsf(a[i]) > r.maxAccel) r.maxAccel = fabsf(a[i]);
+    float gSum = 0;
+    for (size_t i = iFreefall; i < iLand; i++) gSum += fabsf(a[i]);
+    r.gExp = iLand > iFreefall ? gSum / (iLand - iFreefall) : 0;
+
+    // السرعة: شبه منحرف من v=0
+    v[0] = 0;
+    for (size_t i = 1; i < n; i++) v[i] = v[i - 1] + 0.5f * (a[i] + a[i - 1]) * dt(i);
+
+    // قيد السرعة الصفرية: متوسط السرعة في نافذة السكون يجب أن يكون صفراً.
+    // انحياز ثابت في التسارع ينتج انجرافاً خطياً في السرعة، فنطرحه خطياً في الزمن.
+    float vRest = 0, tRest = 0;
+    for (size_t i = iRest; i < n; i++) { vRest += v[i]; tRest += (int32_t)(t[i] - t[0]) / 1e6f; }
+    vRest /= (n - iRest); tRest /= (n - iRest);
+    if (tRest > 0) {
+        float drift = vRest / tRest;
+        for (size_t i = 0; i < n; i++) v[i] -= drift * ((int32_t)(t[i] - t[0]) / 1e6f);
+    }
+    float vLaunch = v[iFreefall];
+
+    // الارتفاع منذ بدء السقوط: سيمبسون على أزواج الفترات، وشبه منحرف للعينة الوسطى
+    // (نكتب الارتفاع فوق مصفوفة التسارع، فالسرعة تبقى لازمة للزوج التالي)
+    size_t m = iLand - iFreefall + 1;
+    float* h = a + iFreefall; // لم نعد نحتاج التسارع أثناء التحليق
+    float* vf = v + iFreefall;
+    float prevV = vf[0];
+    h[0] = 0;
+    for (size_t k = 1; k < m; k++) {
+        float dtk = (int32_t)(t[iFreefall + k] - t[iFreefall + k - 1]) / 1e6f;
+        if (k % 2 == 0) {
+            float dt2 = (int32_t)(t[iFreefall + k] - t[iFreefall + k - 2]) / 1e6f;
+            h[k] = h[k - 2] + dt2 / 6.0f * (vf[k - 2] + 4.0f * vf[k - 1] + vf[k]);
+        } else {
+            h[k] = h[k - 1] + 0.5f * (prevV + vf[k]) * dtk;
+        }
+        prevV = vf[k];
+    }
+
+    // قيد الهبوط: الارتفاع عند الاصطدام = ارتفاع الإطلاق. الخطأ المتبقي يعادل
+    // إزاحة ثابتة في سرعة الإطلاق، فنطرح ميلاً خطياً ونصحح v0 بالقيمة نفسها.
+    r.flightTime = (int32_t)(t[iLand] - t[iFreefall]) / 1e6f;
+    if (r.flightTime <= 0) return r;
+    float vOffset = h[m - 1] / r.flightTime;
+    for (size_t k = 0; k < m; k++) {
+        h[k] -= vOffset * ((int32_t)(t[iFreefall + k] - t[iFreefall]) / 1e6f);
+        if (h[k] > r.apex) r.apex = h[k];
+    }
+    r.v0 = vLaunch - vOffset;
+    r.ok = true;
+    built = true;
+    return r;
+}
+
+size_t Trajectory::flightPoints() const { return built ? iLand - iFreefall + 1 : 0; }
+float Trajectory::flightTimeAt(size_t i) const { return (int32_t)(t[iFreefall + i] - t[iFreefall]) / 1e6f; }
+float Trajectory::flightHeightAt(size_t i) const { return a[iFreefall + i]; }
@@ -0,0 +1,58 @@
+// trajectory.hpp - تسجيل رمية المقذوف كاملة وإعادة بناء مسارها مرة واحدة عند DONE
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// يُسجَّل التسارع العمودي الصافي (m/s², بعد طرح الجاذبية) مع أختامه الزمنية
+// من قبل لحظة كشف القذف بقليل حتى استقرار الجهاز بعد الهبوط. عند الانتهاء:
+//  - السرعة بالتكامل شبه المنحرف، بدءاً من سرعة صفرية (الجهاز ساكن قبل القذف)
+//  - قيد السرعة الصفرية في نافذة السكون الأخيرة: يُطرح انجراف خطي في الزمن
+//  - الارتفاع بقاعدة سيمبسون (شبه منحرف للفترة الفردية الأخيرة)
+//  - قيد الهبوط المعلوم: الهبوط على ارتفاع الإطلاق نفسه، فيُصحح ميل الارتفاع أثناء التحليق
+class Trajectory {
+public:
+    static constexpr size_t CAPACITY = 2048;    // ~4s عند 500Hz
+    static constexpr size_t PRE_TRIGGER = 128;  // ما قبل تجاوز عتبة القذف (بداية الدفع)
+    // نهاية التحليق: أول عينة بعد بدء السقوط يرتفع فيها التسارع الصافي فوق -0.5g
+    static constexpr float FLIGHT_END_G = -0.5f;
+
+    struct Result {
+        bool ok;
+        float v0;          // السرعة لحظة بدء السقوط الحر (m/s)
+        float flightTime;  // من بدء السقوط حتى الاصطدام (s)
+        float apex;        // أقصى ارتفاع فوق نقطة الإطلاق (m)
+        float gExp;        // متوسط |التسارع| أثناء التحليق (m/s²)
+        float maxAccel;    // أكبر |تسارع| أثناء الدفع (m/s²)
+    };
+
+    void reset();
+    // قبل القذف: حلقة صغيرة لآخر PRE_TRIGGER عينة
+    void pushPre(uint32_t t_us, float a);
+    // لحظة كشف القذف: تُنقل عينات ما قبل الزناد إلى بداية السجل
+    void beginThrow();
+    // يرجع false عند امتلاء السجل
+    bool push(uint32_t t_us, float a);
+    void markFreefall();                  // آخر عينة مسجلة هي أول عينة سقوط حر
+    void markRest(size_t restSamples);    // آخر restSamples عينة كانت ساكنة
+
+    Result reconstruct(float gravity);
+
+    // المسار المعاد بناؤه أثناء التحليق (بعد reconstruct)
+    size_t flightPoints() const;
+    float flightTimeAt(size_t i) const;   // ثوانٍ منذ بدء السقوط
+    float flightHeightAt(size_t i) const; // متر فوق نقطة الإطلاق
+
+private:
+    uint32_t t[CAPACITY];
+    float a[CAPACITY];   // التسارع، ثم الارتفاع أثناء التحليق بعد reconstruct
+    float v[CAPACITY];   // السرعة
+    size_t n = 0;
+    uint32_t preT[PRE_TRIGGER];
+    float preA[PRE_TRIGGER];
+    size_t preCount = 0, preHead = 0;
+    size_t iFreefall = 0, iRest = 0, iLand = 0;
+    bool built = false;
+
+    float dt(size_t i) const { return (int32_t)(t[i] - t[i - 1]) / 1e6f; }
+};
@@ -0,0 +1,45 @@
+// web.cpp - إرسال الملفات الثابتة المضغوطة مع التخزين المؤقت في المتصفح
+#include "web.hpp"
+#include "web_assets.h"
+
+namespace {
+  const size_t ASSET_COUNT = sizeof(WEB_ASSETS) / sizeof(WEB_ASSETS[0]);
+  const char* HEADER_KEYS[] = {"If-None-Match"};
+
+  bool isPage(const Web::Asset* a) { return strcmp(a->mime, "text/html") == 0; }
+}
+
+namespace Web {
+  const Asset* find(const char* path) {
+    for (size_t i = 0; i < ASSET_COUNT; i++) {
+      if (strcmp(WEB_ASSETS[i].path, path) == 0) return &WEB_ASSETS[i];
+    }
+    return nullptr;
+  }
+
+  void send(WebServer& server, const char* path) {
+    const Asset* a = find(path);
+    if (!a) { server.send(404, "text/plain", "Not found"); return; }
+    // الصفحات يُعاد التحقق منها في كل طلب (معالجها يعيد ضبط التجربة)؛ الباقي يُخزن أسبوعاً
+    if (notModified(server, a->etag, isPage(a) ? "no-cache" : "public, max-age=604800")) return;
+    server.sendHeader("Content-Encoding", "gzip");
+    server.send_P(200, a->mime, (const char*)a->data, a->len);
+  }
+
+  bool notModified(WebServer& server, const char* etag, const char* cacheControl) {
+    server.sendHeader("Cache-Control", cacheControl);
+    server.sendHeader("ETag", etag);
+    if (server.header("If-None-Match") != etag) return false;
+    server.send(304);
+    return true;
+  }
+
+  void begin(WebServer& server) {
+    server.collectHeaders(HEADER_KEYS, 1);
+    for (size_t i = 0; i < ASSET_COUNT; i++) {
+      const Asset* a = &WEB_ASSETS[i];
+      if (isPage(a)) continue; // للصفحات معالجات خاصة في main.cpp
+      server.on(a->path, HTTP_GET, [&server, a]() { send(server, a->path); });
+    }
+  }
+}
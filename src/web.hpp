@@ -0,0 +1,30 @@
+// web.hpp - الصفحات والملفات الثابتة مضغوطة مسبقاً (gzip) في الفلاش
+// تولّدها tools/build_web.py من مجلد web/ قبل كل بناء في src/web_assets.h
+#pragma once
+
+#include <Arduino.h>
+#include <WebServer.h>
+
+namespace Web {
+  struct Asset {
+    const char* path;   // "/" أو "/projectile" أو "/tone-lite.js" ...
+    const char* mime;
+    const uint8_t* data; // gzip في PROGMEM
+    size_t len;
+    const char* etag;   // بصيغة ترويسة HTTP (مع علامتي التنصيص)
+  };
+
+  const Asset* find(const char* path);
+
+  // يرسل الملف مباشرة من الفلاش (بلا نسخ إلى String) مع Content-Encoding: gzip و ETag.
+  // يرد 304 إن طابق If-None-Match، و 404 إن لم يوجد الملف
+  void send(WebServer& server, const char* path);
+
+  // يرسل ترويستي Cache-Control و ETag، ويرد 304 إن طابق If-None-Match (فيرجع true
+  // ولا يبقى ما يُرسل). تستعمله الملفات الثابتة والردود المخزنة بإصدارها (/results)
+  bool notModified(WebServer& server, const char* etag, const char* cacheControl);
+
+  // يسجل مسارات الملفات غير الصفحات (js, css, خطوط) ويطلب جمع ترويسة If-None-Match.
+  // يُستدعى قبل server.begin()
+  void begin(WebServer& server);
+}
@@ -0,0 +1,117 @@
+"""Packs web/ into a generated PROGMEM header (src/web_assets.h).
+
+Runs as a PlatformIO pre-build script (extra_scripts = pre:tools/build_web.py)
+and can also be run by hand: python3 tools/build_web.py
+
+Every file is minified conservatively (per-line trim, blank lines and CSS
+comments dropped; line breaks are kept so inline JS is never changed),
+gzipped deterministically, and given a strong ETag from its SHA-256.
+web/<name>.html is served at /<name> (index.html at /), everything else at
+its path below web/. A fonts.css is generated from web/fonts/<Family>-<weight>.woff2
+(tools/subset_fonts.py writes those); with no fonts present it is empty and pages
+fall back to system fonts.
+"""
+import gzip
+import hashlib
+import io
+import os
+import re
+
+MIME = {
+    ".html": "text/html",
+    ".js": "application/javascript",
+    ".css": "text/css",
+    ".woff2": "font/woff2",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+}
+TEXT = (".html", ".js", ".css", ".svg")
+
+
+def minify(data, ext):
+    text = data.decode("utf-8")
+    if ext == ".css":
+        text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    lines = (line.strip() for line in text.splitlines())
+    return "\n".join(line for line in lines if line).encode("utf-8")
+
+
+def fonts_css(web_dir):
+    rules = []
+    font_dir = os.path.join(web_dir, "fonts")
+    if os.path.isdir(font_dir):
+        for name in sorted(os.listdir(font_dir)):
+            m = re.match(r"^([A-Za-z0-9 ]+)-(\d{3})\.woff2$", name)
+            if not m:
+                continue
+            rules.append(
+                "@font-face{font-family:'%s';font-weight:%s;font-display:swap;src:url(/fonts/%s) format('woff2')}"
+                % (m.group(1), m.group(2), name))
+    return ("\n".join(rules) or "/* no local fonts: system fallback */").encode("utf-8")
+
+
+def collect(web_dir):
+    assets = []
+    for root, _, files in os.walk(web_dir):
+        for name in sorted(files):
+            path = os.path.join(root, name)
+            rel = os.path.relpath(path, web_dir).replace(os.sep, "/")
+            ext = os.path.splitext(name)[1].lower()
+            if ext not in MIME:
+                continue
+            with open(path, "rb") as f:
+                data = f.read()
+            if ext == ".html":
+                route = "/" if rel == "index.html" else "/" + rel[:-len(".html")]
+            else:
+                route = "/" + rel
+            assets.append((route, ext, data))
+    assets.append(("/fonts.css", ".css", fonts_css(web_dir)))
+    return sorted(assets)
+
+
+def pack(data):
+    buf = io.BytesIO()
+    with gzip.GzipFile(fileobj=buf, mode="wb", compresslevel=9, mtime=0) as gz:
+        gz.write(data)
+    return buf.getvalue()
+
+
+def generate(project_dir):
+    web_dir = os.path.join(project_dir, "web")
+    out_path = os.path.join(project_dir, "src", "web_assets.h")
+    out = ["// Generated by tools/build_web.py from web/ - do not edit.", "#pragma once", ""]
+    table = []
+    raw_total = gz_total = 0
+    for i, (route, ext, data) in enumerate(collect(web_dir)):
+        if ext in TEXT:
+            data = minify(data, ext)
+        gz = pack(data)
+        raw_total += len(data)
+        gz_total += len(gz)
+        etag = hashlib.sha256(gz).hexdigest()[:16]
+        body = ",".join(str(b) for b in gz)
+        out.append("static const uint8_t WEB_ASSET_%d[] PROGMEM = {%s};" % (i, body))
+        table.append('  {"%s", "%s", WEB_ASSET_%d, %d, "\\"%s\\""},' % (route, MIME[ext], i, len(gz), etag))
+    out.append("")
+    out.append("static const Web::Asset WEB_ASSETS[] = {")
+    out.extend(table)
+    out.append("};")
+    out.append("")
+    text = "\n".join(out)
+    old = None
+    if os.path.exists(out_path):
+        with open(out_path) as f:
+            old = f.read()
+    if text != old:
+        with open(out_path, "w") as f:
+            f.write(text)
+    print("web assets: %d files, %d bytes -> %d gzipped" % (len(table), raw_total, gz_total))
+
+
+try:
+    Import("env")  # noqa: F821 (PlatformIO)
+    generate(env.subst("$PROJECT_DIR"))  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
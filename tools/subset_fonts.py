@@ -0,0 +1,66 @@
+"""Subsets TTF/OTF fonts into web/fonts/<Family>-<weight>.woff2 for build_web.py.
+
+Keeps only the glyphs the pages use (Latin, Latin-1, Arabic and its presentation
+forms, common punctuation and math signs) plus the Arabic shaping features, so
+each weight stays small enough for the PROGMEM header. Needs fontTools and
+brotli (pip install fonttools brotli); run once by hand and commit the output:
+
+    python3 tools/subset_fonts.py 400=Tajawal-Regular.ttf 500=Tajawal-Medium.ttf 700=Tajawal-Bold.ttf
+
+The family name is read from the font (typographic family first, spaces dropped).
+"""
+import os
+import re
+import sys
+
+from fontTools import subset
+from fontTools.ttLib import TTFont
+
+UNICODES = [
+    *range(0x0020, 0x007F),  # Basic Latin
+    *range(0x00A0, 0x0100),  # Latin-1 (° ² µ × ÷ ±)
+    *range(0x0600, 0x0700),  # Arabic
+    *range(0xFB50, 0xFE00),  # Arabic Presentation Forms-A
+    *range(0xFE70, 0xFF00),  # Arabic Presentation Forms-B
+    *range(0x2010, 0x2028),  # dashes, quotes, bullet, ellipsis
+    0x200C, 0x200D, 0x200E, 0x200F,  # ZWNJ, ZWJ, LRM, RLM
+    0x2030, 0x2032, 0x2033, 0x2039, 0x203A, 0x2070, 0x00B9, 0x2212, 0x2248, 0x2260, 0x2264, 0x2265,
+    0x2190, 0x2191, 0x2192, 0x2193, 0x221A, 0x221E, 0x0394, 0x03B8, 0x03BC, 0x03C0, 0x03C9,
+]
+
+
+def family(font):
+    names = font["name"]
+    for name_id in (16, 1):
+        record = names.getName(name_id, 3, 1) or names.getName(name_id, 1, 0)
+        if record:
+            return re.sub(r"[^A-Za-z0-9 ]", "", record.toUnicode()).strip()
+    raise ValueError("font has no family name")
+
+
+def main(args):
+    if not args:
+        sys.exit(__doc__)
+    out_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "web", "fonts")
+    options = subset.Options()
+    options.flavor = "woff2"
+    options.layout_features = ["*"]
+    options.name_IDs = [1, 2, 4, 6, 16, 17]
+    options.notdef_outline = True
+    options.hinting = False
+    for arg in args:
+        weight, _, path = arg.partition("=")
+        if not re.match(r"^\d{3}$", weight) or not path:
+            sys.exit("expected WEIGHT=FONT, got %s" % arg)
+        font = TTFont(path)
+        subsetter = subset.Subsetter(options)
+        subsetter.populate(unicodes=UNICODES)
+        subsetter.subset(font)
+        out = os.path.join(out_dir, "%s-%s.woff2" % (family(font).replace(" ", ""), weight))
+        font.flavor = "woff2"
+        font.save(out)
+        print("%-24s %6d bytes" % (os.path.relpath(out, os.path.join(out_dir, "..", "..")), os.path.getsize(out)))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,26 @@
+// Subscribes to the device's push channel (Server-Sent Events on port 81) and
+// calls onResults with the same JSON /results returns, sent only on change.
+// Falls back to slow /results polling if the browser or network can't hold
+// the stream open. Returns a handle with close().
+function subscribeResults(onResults) {
+  var es = null, poll = null;
+  function startPolling() {
+    if (poll) return;
+    poll = setInterval(function () {
+      fetch('/results').then(function (r) { return r.json(); }).then(onResults).catch(function () {});
+    }, 1000);
+  }
+  if (window.EventSource) {
+    es = new EventSource(location.protocol + '//' + location.hostname + ':81/events');
+    es.addEventListener('results', function (e) { onResults(JSON.parse(e.data)); });
+    es.onerror = function () { if (es.readyState === EventSource.CLOSED) startPolling(); };
+  } else {
+    startPolling();
+  }
+  return {
+    close: function () {
+      if (es) es.close();
+      if (poll) clearInterval(poll);
+    }
+  };
+}
@@ -0,0 +1,41 @@
+// Minimal stand-in for the parts of Tone.js the pages use (hover blips), so
+// they work offline in AP mode without the CDN. Plain WebAudio underneath.
+(function () {
+  var ctx = null;
+  function audio() {
+    if (!ctx) {
+      var A = window.AudioContext || window.webkitAudioContext;
+      if (A) ctx = new A();
+    }
+    return ctx;
+  }
+  // "C5" -> Hz (A4 = 440)
+  function freq(note) {
+    var m = /^([A-G])(#?)(\d)$/.exec(note);
+    if (!m) return 440;
+    var k = {C: -9, D: -7, E: -5, F: -4, G: -2, A: 0, B: 2}[m[1]] + (m[2] ? 1 : 0) + (m[3] - 4) * 12;
+    return 440 * Math.pow(2, k / 12);
+  }
+  // "8n" -> seconds at Tone's default 120 bpm (whole note = 2 s)
+  function seconds(d) {
+    var m = /^(\d+)n$/.exec(d);
+    return m ? 2 / m[1] : (parseFloat(d) || 0.25);
+  }
+  function Synth() {}
+  Synth.prototype.toDestination = function () { return this; };
+  Synth.prototype.triggerAttackRelease = function (note, dur) {
+    var a = audio();
+    if (!a) return;
+    var o = a.createOscillator(), g = a.createGain(), t = a.currentTime, len = seconds(dur);
+    o.type = 'triangle';
+    o.frequency.value = freq(note);
+    g.gain.setValueAtTime(0.2, t);
+    g.gain.exponentialRampToValueAtTime(0.001, t + len);
+    o.connect(g); g.connect(a.destination);
+    o.start(t); o.stop(t + len);
+  };
+  window.Tone = {
+    Synth: Synth,
+    get context() { return audio() || {state: 'running', resume: function () {}}; }
+  };
+})();
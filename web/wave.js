@@ -0,0 +1,68 @@
+// Live accel chart fed by the device's binary stream (GET :81/stream?hz=N).
+// Wire format: "IMU1", u16 accel LSB/g, u16 gyro LSB/dps, u16 frame rate,
+// u16 decimation, then 16-byte little-endian frames:
+// u32 t_us, i16 ax, ay, az, i16 gx, gy, gz.
+function startWaveform(canvasId, hz) {
+  var canvas = document.getElementById(canvasId);
+  if (!canvas || !window.fetch || !window.ReadableStream) return;
+  var ctx = canvas.getContext('2d');
+  var SECONDS = 5, FRAME = 16, HEADER = 12;
+  var colors = ['#e53935', '#43a047', '#1e88e5'];
+  var points = [], accelLsb = 4096, dirty = false;
+
+  function draw() {
+    dirty = false;
+    var w = canvas.width, h = canvas.height;
+    ctx.clearRect(0, 0, w, h);
+    ctx.strokeStyle = '#ccc';
+    ctx.beginPath(); ctx.moveTo(0, h / 2); ctx.lineTo(w, h / 2); ctx.stroke();
+    if (points.length < 2) return;
+    var tEnd = points[points.length - 1][0], span = SECONDS * 1e6;
+    var range = 2; // ±2 g, grows to fit
+    for (var i = 0; i < points.length; i++)
+      for (var k = 1; k <= 3; k++) range = Math.max(range, Math.abs(points[i][k]));
+    for (var axis = 1; axis <= 3; axis++) {
+      ctx.strokeStyle = colors[axis - 1];
+      ctx.beginPath();
+      for (var j = 0; j < points.length; j++) {
+        var x = w - ((tEnd - points[j][0]) >>> 0) / span * w;
+        var y = h / 2 - points[j][axis] / range * (h / 2 - 2);
+        if (j) ctx.lineTo(x, y); else ctx.moveTo(x, y);
+      }
+      ctx.stroke();
+    }
+  }
+
+  function connect() {
+    var pending = new Uint8Array(0), gotHeader = false;
+    fetch(location.protocol + '//' + location.hostname + ':81/stream?hz=' + hz).then(function (r) {
+      var reader = r.body.getReader();
+      function read() {
+        return reader.read().then(function (chunk) {
+          if (chunk.done) throw new Error('stream closed');
+          var buf = new Uint8Array(pending.length + chunk.value.length);
+          buf.set(pending); buf.set(chunk.value, pending.length);
+          var dv = new DataView(buf.buffer), off = 0;
+          if (!gotHeader) {
+            if (buf.length < HEADER) { pending = buf; return read(); }
+            accelLsb = dv.getUint16(4, true);
+            gotHeader = true; off = HEADER;
+          }
+          for (; off + FRAME <= buf.length; off += FRAME) {
+            points.push([dv.getUint32(off, true),
+                         dv.getInt16(off + 4, true) / accelLsb,
+                         dv.getInt16(off + 6, true) / accelLsb,
+                         dv.getInt16(off + 8, true) / accelLsb]);
+          }
+          pending = buf.slice(off);
+          var tEnd = points.length ? points[points.length - 1][0] : 0;
+          while (points.length && ((tEnd - points[0][0]) >>> 0) > SECONDS * 1e6) points.shift();
+          if (!dirty) { dirty = true; requestAnimationFrame(draw); }
+          return read();
+        });
+      }
+      return read();
+    }).catch(function () { setTimeout(connect, 2000); });
+  }
+  connect();
+}